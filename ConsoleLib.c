@@ -584,6 +584,46 @@ int EditStringArray (char **StringArray, int Size, int StLength, char *Default)
     return c;
   }
 
+// EditStringArray on a _History: Up steps to older items, Down back to newer ones
+
+int EditHistory (_History *History, int StLength, char *Default)
+  {
+    _HistoryItem *Item, *Next;
+    char *Text;
+    int c;
+    int x;
+    //
+    Text = (char *) malloc (StLength);
+    x = ConsoleX;
+    Item = NULL;
+    while (true)
+      {
+        ConsoleCursor (x, ConsoleY);
+        ConsoleClearEOL ();
+        Text [0] = 0;
+        if (Item)
+          StrCopyN (Text, Item->St, StLength);
+        else if (Default)
+          StrCopyN (Text, Default, StLength);
+        c = EditString (Text, StLength, StLength);
+        if (c == KeyUp)
+          {
+            Next = HistoryNext (History, Item, +1);
+            if (Next)
+              Item = Next;
+          }
+        else if ((c == KeyDown) || (c == tab))
+          Item = HistoryNext (History, Item, -1);
+        else
+          break;
+      }
+    if (c != esc)
+      if (Text [0])
+        HistoryAdd (History, Text);
+    free (Text);
+    return c;
+  }
+
 /*
 bool EditStringArray (char **StringArray, int Size, int StLength, char *Default)
   {
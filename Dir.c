@@ -15,6 +15,7 @@
 //  7 Jul 2018 Separate DirEntryFromFilename () from ReadDirSearch ()
 
 #include <dirent.h>
+#include <limits.h>
 #include <sys/stat.h>
 #ifdef _Windows
   #include <dir.h>
@@ -40,6 +41,7 @@ typedef struct DirEntry
     #endif
     //
     bool Tagged;
+    bool Pooled;   // From the pools (_ReadDirScan.Pooled): release only with DirEntryFree or FreeDir
   } _DirEntry;
 
 typedef enum {sName, sExt, sPath, sAttr, sOwnerGroup, sDateTime, sCount, sSize, sZZZZ} _SortMode;
@@ -69,11 +71,11 @@ char *GetCurrentWorkingDirectory (void)   // Caller must free Result
     return p2;
   }
 
-char *GetItemPathFrom (char *Path, _DirEntry *Item)   // Caller must free Result
+char *ArenaGetItemPathFrom (_Arena *Arena, char *Path, _DirEntry *Item)   // Result from Arena, or malloc if NULL
   {
     char *Res, *r;
     //
-    Res = (char *) malloc (StrLength (Path) + StrLength (Item->Name) + 2);
+    Res = (char *) LibAlloc (Arena, StrLength (Path) + StrLength (Item->Name) + 2);
     r = Res;
     if (Path && Path [0])
       {
@@ -89,11 +91,74 @@ char *GetItemPathFrom (char *Path, _DirEntry *Item)   // Caller must free Result
     return Res;
   }
 
+char *GetItemPathFrom (char *Path, _DirEntry *Item)   // Caller must free Result
+  {
+    return ArenaGetItemPathFrom (NULL, Path, Item);
+  }
+
 char *GetItemPath (_DirEntry *Item)   // Caller must free Result
   {
     return GetItemPathFrom (Item->Path, Item);
   }
 
+char *ArenaGetItemPath (_Arena *Arena, _DirEntry *Item)
+  {
+    return ArenaGetItemPathFrom (Arena, Item->Path, Item);
+  }
+
+// Break an Item's full path (as GetItemPath) into Path, Delimiter and Name
+void ItemPathSegments (_DirEntry *Item, char **Segment, char *Delimiter)
+  {
+    Segment [0] = Item->Path;
+    if (Segment [0] == NULL)
+      Segment [0] = (char *) StrNull;
+    Delimiter [0] = 0;
+    if (Segment [0][0] && *(StrEnd (Segment [0]) - 1) != PathDelimiter)
+      Delimiter [0] = PathDelimiter;
+    Delimiter [1] = 0;
+    Segment [1] = Delimiter;
+    Segment [2] = Item->Name;
+    if (Segment [2] == NULL)
+      Segment [2] = (char *) StrNull;
+  }
+
+// Compare full paths of A and B as StrCompareCase would, without building them
+int ItemPathCompareCase (_DirEntry *A, _DirEntry *B, bool Cased)
+  {
+    char *SegA [3], *SegB [3];
+    char DelimA [2], DelimB [2];
+    char *a, *b;
+    int i, j;
+    int delta;
+    //
+    ItemPathSegments (A, SegA, DelimA);
+    ItemPathSegments (B, SegB, DelimB);
+    i = j = 0;
+    a = SegA [0];
+    b = SegB [0];
+    while (true)
+      {
+        while (*a == 0 && i < 2)   // step to next segment
+          a = SegA [++i];
+        while (*b == 0 && j < 2)
+          b = SegB [++j];
+        if (*a == 0 && *b == 0)
+          return 0;
+        if (*a == 0)
+          return -1;
+        if (*b == 0)
+          return +1;
+        if (Cased)
+          delta = *a - *b;
+        else
+          delta = UpCase (*a) - UpCase (*b);
+        if (delta)
+          return delta;
+        a++;
+        b++;
+      }
+  }
+
 #ifdef _Windows
   #define lstat stat
 #endif
@@ -210,6 +275,32 @@ void FreeDirItemContents (_DirEntry *Item)
     Item->SymLinkTarget = NULL;
   }
 
+// Cleared. Not Pooled: may also be released with FreeDirItemContents and free
+_DirEntry *DirEntryNew (bool Pooled)
+  {
+    _DirEntry *Res;
+    //
+    if (Pooled)
+      Res = (_DirEntry *) PoolAlloc (sizeof (_DirEntry));
+    else
+      Res = (_DirEntry *) malloc (sizeof (_DirEntry));
+    if (Res)
+      {
+        MemSet (Res, 0, sizeof (_DirEntry));
+        Res->Pooled = Pooled;
+      }
+    return Res;
+  }
+
+void DirEntryFree (_DirEntry *Item)   // Contents and all
+  {
+    FreeDirItemContents (Item);
+    if (Item->Pooled)
+      PoolFree (Item, sizeof (_DirEntry));
+    else
+      free (Item);
+  }
+
 void FreeDir (_DirEntry *Dir)
   {
     _DirEntry *Dir_;
@@ -217,8 +308,7 @@ void FreeDir (_DirEntry *Dir)
     while (Dir)
       {
         Dir_ = Dir->Next;
-        FreeDirItemContents (Dir);
-        free (Dir);
+        DirEntryFree (Dir);
         Dir = Dir_;
       }
   }
@@ -235,6 +325,452 @@ void FreeDir (_DirEntry *Dir)
 
 typedef byte _ReadDirCallback (_DirEntry *Item, int Depth);
 
+////////////////////////////////////////////////////////////////////////////
+//
+// Name Filter: include & exclude patterns, compiled once, tested on the bare name
+//   Glob: * ? [a-z] [!a-z] (case sensitive). Wild: StrMatch spmWild over the whole name.
+//   Exclude applies to everything, an excluded directory is not read at all.
+//   A trailing PathDelimiter makes an exclude match directories only ("node_modules/").
+//   Include applies to files only, so directories are still searched (and an include
+//   has no directory-only form).
+
+typedef enum {dpLiteral, dpPrefix, dpSuffix, dpGlob, dpWild} _DirPatternKind;
+
+typedef struct DirPattern
+  {
+    struct DirPattern *Next;
+    char *Pattern;   // Without the '*' for dpPrefix & dpSuffix
+    int Length;
+    _DirPatternKind Kind;
+    bool DirOnly;   // Excludes only
+  } _DirPattern;
+
+typedef struct
+  {
+    _DirPattern *Include;
+    _DirPattern *Exclude;
+  } _DirFilter;
+
+void DirFilterInit (_DirFilter *Filter)
+  {
+    MemSet (Filter, 0, sizeof (_DirFilter));
+  }
+
+void DirFilterAdd (_DirFilter *Filter, char *Pattern, bool Exclude, bool Wild)
+  {
+    _DirPattern *p;
+    char *s;
+    int Stars, Specials;
+    //
+    p = (_DirPattern *) malloc (sizeof (_DirPattern));
+    MemSet (p, 0, sizeof (_DirPattern));
+    StrAssign (&p->Pattern, Pattern);
+    p->Length = StrLength (p->Pattern);
+    if (Exclude && p->Length > 1 && p->Pattern [p->Length - 1] == PathDelimiter)
+      {
+        p->Pattern [--p->Length] = 0;
+        p->DirOnly = true;
+      }
+    Stars = 0;
+    Specials = 0;
+    for (s = p->Pattern; *s; s++)
+      if (*s == '*')
+        Stars++;
+      else if (*s == '?' || *s == '[')
+        Specials++;
+    if (Wild)
+      p->Kind = dpWild;
+    else if (Stars == 0 && Specials == 0)
+      p->Kind = dpLiteral;
+    else if (Stars == 1 && Specials == 0 && p->Pattern [0] == '*')   // "*.c"
+      {
+        p->Kind = dpSuffix;
+        MemMove (p->Pattern, &p->Pattern [1], p->Length--);
+      }
+    else if (Stars == 1 && Specials == 0 && p->Pattern [p->Length - 1] == '*')   // "tmp*"
+      {
+        p->Kind = dpPrefix;
+        p->Pattern [--p->Length] = 0;
+      }
+    else
+      p->Kind = dpGlob;
+    if (Exclude)
+      {
+        p->Next = Filter->Exclude;
+        Filter->Exclude = p;
+      }
+    else
+      {
+        p->Next = Filter->Include;
+        Filter->Include = p;
+      }
+  }
+
+void DirFilterFree (_DirFilter *Filter)
+  {
+    _DirPattern *p;
+    int i;
+    //
+    for (i = 0; i < 2; i++)
+      while ((p = i ? Filter->Include : Filter->Exclude))
+        {
+          if (i)
+            Filter->Include = p->Next;
+          else
+            Filter->Exclude = p->Next;
+          free (p->Pattern);
+          free (p);
+        }
+  }
+
+bool GlobMatchClass (char **Pattern, char c)   // *Pattern on the '['. Moved past the ']'
+  {
+    char *p;
+    bool Not, Res;
+    //
+    p = *Pattern + 1;
+    Not = (*p == '!' || *p == '^');
+    if (Not)
+      p++;
+    Res = false;
+    do
+      {
+        if (*p == 0)   // No ']': take the '[' literally
+          {
+            (*Pattern)++;
+            return c == '[';
+          }
+        if (p [1] == '-' && p [2] && p [2] != ']')
+          {
+            if ((unsigned char) c >= (unsigned char) p [0] && (unsigned char) c <= (unsigned char) p [2])
+              Res = true;
+            p += 3;
+          }
+        else if (*p++ == c)
+          Res = true;
+      }
+    while (*p != ']');
+    *Pattern = p + 1;
+    return Res != Not;
+  }
+
+bool GlobMatch (char *Pattern, char *St)
+  {
+    char *StarP, *StarS, *p;
+    //
+    StarP = NULL;
+    StarS = NULL;
+    while (*St)
+      {
+        if (*Pattern == '*')   // Try matching nothing first, backtrack to here
+          {
+            StarP = ++Pattern;
+            StarS = St;
+            continue;
+          }
+        p = Pattern;
+        if (*p == '?' ? (p++, true) : *p == '[' ? GlobMatchClass (&p, *St) : *p && *p++ == *St)
+          {
+            Pattern = p;
+            St++;
+            continue;
+          }
+        if (StarP == NULL)
+          return false;
+        Pattern = StarP;
+        St = ++StarS;
+      }
+    while (*Pattern == '*')
+      Pattern++;
+    return *Pattern == 0;
+  }
+
+bool DirPatternMatch (_DirPattern *p, char *Name, int NameLength)
+  {
+    switch (p->Kind)
+      {
+        case dpLiteral:
+          return NameLength == p->Length && StrCompare (Name, p->Pattern) == 0;
+        case dpPrefix:
+          return StrMatch (Name, p->Pattern, 0, spmStrict) != 0;
+        case dpSuffix:
+          return NameLength >= p->Length && StrCompare (&Name [NameLength - p->Length], p->Pattern) == 0;
+        case dpGlob:
+          return GlobMatch (p->Pattern, Name);
+        case dpWild:
+          return (int) StrMatch (Name, p->Pattern, 0, spmWild) == NameLength;
+      }
+    return false;
+  }
+
+// Directory: 1 yes, 0 no, -1 not known yet
+// Returns 1 wanted, 0 not wanted, -1 can't tell until Directory is known
+int DirFilterMatch (_DirFilter *Filter, char *Name, int Directory)
+  {
+    _DirPattern *p;
+    int NameLength;
+    bool Known;
+    //
+    NameLength = StrLength (Name);
+    Known = true;
+    for (p = Filter->Exclude; p; p = p->Next)
+      if (DirPatternMatch (p, Name, NameLength))
+        {
+          if (!p->DirOnly || Directory == 1)
+            return 0;
+          if (Directory == -1)
+            Known = false;
+        }
+    if (Directory == 1 || Filter->Include == NULL)
+      return Known ? 1 : -1;
+    for (p = Filter->Include; p; p = p->Next)
+      if (DirPatternMatch (p, Name, NameLength))
+        return Known ? 1 : -1;
+    return Directory == -1 ? -1 : 0;   // A directory would still be wanted
+  }
+
+#ifndef _Windows
+
+////////////////////////////////////////////////////////////////////////////
+//
+// Read Directory with a Scan context
+//   No chdir and no statics so it may run on a background thread.
+//   Cancel from any thread with ReadDirCancel (): it is checked once per entry.
+//   Progress is called at most every ProgressInterval ms.
+//   Budget: MaxEntries, MaxDepth (1: this directory only) and Deadline (ClockMS). 0: no limit
+//   Filter: names are matched on d_name first, a stat is only needed if the type is unknown
+//   Pooled: entries come from the per-thread pools, so parallel scans don't contend on
+//   malloc. The list must then be released with FreeDir (or DirEntryFree), never free
+
+typedef struct ReadDirScan _ReadDirScan;
+
+typedef void _ReadDirProgress (_ReadDirScan *Scan);
+
+struct ReadDirScan
+  {
+    int Cancel;   // Use ReadDirCancel ()
+    int MaxEntries;
+    int MaxDepth;
+    int Deadline;
+    _ReadDirProgress *Progress;
+    int ProgressInterval;
+    _DirFilter *Filter;   // Checked before each stat. NULL: everything
+    bool Pooled;   // Entries from the pools: see above
+    void *Data;   // For the caller
+    // State
+    bool Stopped;   // Cancelled or out of budget
+    int Entries;
+    int Depth;
+    char *Path;   // Directory being read
+    int TotalCount;
+    longint TotalSize;
+    int ClockCountdown;
+    int ProgressNext;
+  };
+
+#define ReadDirScanClockEvery 64   // Entries between looks at the clock
+
+void ReadDirScanInit (_ReadDirScan *Scan)
+  {
+    MemSet (Scan, 0, sizeof (_ReadDirScan));
+    Scan->ProgressInterval = 100;
+  }
+
+void ReadDirCancel (_ReadDirScan *Scan)
+  {
+    __atomic_store_n (&Scan->Cancel, 1, __ATOMIC_RELAXED);
+  }
+
+bool ReadDirScanStop (_ReadDirScan *Scan)
+  {
+    int Now;
+    //
+    if (__atomic_load_n (&Scan->Cancel, __ATOMIC_RELAXED))
+      Scan->Stopped = true;
+    else if (Scan->MaxEntries && Scan->Entries >= Scan->MaxEntries)
+      Scan->Stopped = true;
+    else if (--Scan->ClockCountdown <= 0)
+      {
+        Scan->ClockCountdown = ReadDirScanClockEvery;
+        Now = ClockMS ();
+        if (Scan->Deadline && (int) (Now - Scan->Deadline) >= 0)
+          Scan->Stopped = true;
+        else if (Scan->Progress && (int) (Now - Scan->ProgressNext) >= 0)
+          {
+            Scan->ProgressNext = Now + Scan->ProgressInterval;
+            Scan->Progress (Scan);
+          }
+      }
+    return Scan->Stopped;
+  }
+
+bool DirEntryFromFilenameAt (int DirFd, char *Path, char *Filename, _DirEntry *Item)
+  {
+    struct stat st;
+    char *lnk;
+    int lnksz;
+    //
+    if (fstatat (DirFd, Filename, &st, AT_SYMLINK_NOFOLLOW) == 0)
+      {
+        StrAssign (&Item->Path, Path);
+        StrAssign (&Item->Name, Filename);
+        Item->Directory = S_ISDIR (st.st_mode) != 0;
+        Item->SymLink = S_ISLNK (st.st_mode) != 0;
+        Item->Size = st.st_size;
+        Item->UID = st.st_uid;
+        Item->GID = st.st_gid;
+        if (Item->SymLink)   // This is a symbolic link
+          {
+            lnk = (char *) malloc (Item->Size + 1);
+            lnksz = readlinkat (DirFd, Filename, lnk, Item->Size + 1);   // read link target
+            if (lnksz == Item->Size)   // correct length of target string
+              {
+                lnk [lnksz] = 0;   // terminate string
+                Item->SymLinkTarget = lnk;
+              }
+            else
+              free (lnk);
+          }
+        Item->DateTime = st.st_mtime;
+        Item->Attrib = st.st_mode;   // Keep for permissions etc
+        Item->Tagged = false;
+        return true;
+      }
+    return false;
+  }
+
+// Read the directory open on DirFd (closed here) whose full path is Path
+void ReadDirScanAt (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack, _ReadDirScan *Scan, int DirFd, char *Path)
+  {
+    _DirEntry *New;
+    struct dirent *de;
+    DIR *Dir;
+    byte Res;
+    int SubFd;
+    char *SubPath;
+    int TotalCount_;
+    longint TotalSize_;
+    int Filtered;
+    //
+    Dir = fdopendir (DirFd);
+    if (Dir == NULL)
+      {
+        close (DirFd);
+        return;
+      }
+    Scan->Depth++;
+    New = NULL;
+    while (true)
+      {
+        Scan->Path = Path;
+        if (ReadDirScanStop (Scan))
+          break;
+        de = readdir (Dir);
+        if (de == NULL)
+          break;
+        if (StrCompare (de->d_name, ".") && StrCompare (de->d_name, ".."))
+          {
+            Filtered = 1;
+            if (Scan->Filter)
+              {
+                Filtered = DirFilterMatch (Scan->Filter, de->d_name, de->d_type == DT_UNKNOWN ? -1 : de->d_type == DT_DIR);
+                if (Filtered == 0)
+                  continue;
+              }
+            if (New == NULL)
+              New = DirEntryNew (Scan->Pooled);
+            if (DirEntryFromFilenameAt (dirfd (Dir), Path, de->d_name, New))
+              {
+                if (Filtered == -1)   // Known now
+                  if (DirFilterMatch (Scan->Filter, New->Name, New->Directory) == 0)
+                    {
+                      FreeDirItemContents (New);
+                      continue;
+                    }
+                Scan->Entries++;
+                if (New->Directory && Recurse && (Scan->MaxDepth == 0 || Scan->Depth < Scan->MaxDepth))
+                  {
+                    SubFd = openat (dirfd (Dir), New->Name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                    if (SubFd >= 0)
+                      {
+                        SubPath = GetItemPath (New);
+                        TotalCount_ = Scan->TotalCount;
+                        TotalSize_ = Scan->TotalSize;
+                        ReadDirScanAt (List, Recurse, CallBack, Scan, SubFd, SubPath);
+                        New->Count = Scan->TotalCount - TotalCount_;
+                        New->Size = Scan->TotalSize - TotalSize_;
+                        free (SubPath);
+                      }
+                  }
+                Res = ReadDirInList | ReadDirInStats;
+                if (CallBack)
+                  Res = CallBack (New, Scan->Depth);  // Is this wanted?
+                if (Res & ReadDirInStats)    // Do stats
+                  if (S_ISREG (New->Attrib))
+                    {
+                      Scan->TotalCount++;
+                      Scan->TotalSize += New->Size;
+                    }
+                if (Res & ReadDirInList)   // Add to top of list
+                  {
+                    New->Next = *List;
+                    *List = New;
+                    New = NULL;
+                  }
+                else   // not wanted
+                  FreeDirItemContents (New);   // free stuff in New
+              }
+          }
+      }
+    closedir (Dir);
+    if (New)
+      DirEntryFree (New);
+    Scan->Depth--;
+  }
+
+// Read Path (NULL: the current directory). Returns false if it couldn't be opened
+bool ReadDirScan (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack, _ReadDirScan *Scan, char *Path)
+  {
+    char *FullPath;
+    int DirFd;
+    //
+    if (Path == NULL)
+      Path = (char *) ".";
+    FullPath = realpath (Path, NULL);
+    DirFd = open (Path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (FullPath && DirFd >= 0)
+      {
+        Scan->ClockCountdown = 0;
+        Scan->ProgressNext = ClockMS () + Scan->ProgressInterval;
+        ReadDirScanAt (List, Recurse, CallBack, Scan, DirFd, FullPath);
+        Scan->Path = NULL;
+        free (FullPath);
+        return true;
+      }
+    if (DirFd >= 0)
+      close (DirFd);
+    free (FullPath);
+    return false;
+  }
+
+void ReadDirEscape (_ReadDirScan *Scan)   // Progress for ReadDir: Escape key cancels
+  {
+    if (GetKey () == esc)
+      ReadDirCancel (Scan);
+  }
+
+void ReadDir (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack)
+  {
+    _ReadDirScan Scan;
+    //
+    ReadDirScanInit (&Scan);
+    Scan.Progress = ReadDirEscape;
+    Scan.ProgressInterval = 50;
+    ReadDirScan (List, Recurse, CallBack, &Scan, NULL);
+  }
+
+#else
+
 void ReadDir (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack)
   {
     _DirEntry *New;
@@ -267,10 +803,7 @@ void ReadDir (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack)
             if (StrCompare (de->d_name, ".") && StrCompare (de->d_name, ".."))
               {
                 if (New == NULL)
-                  {
-                    New = (_DirEntry *) malloc (sizeof (_DirEntry));
-                    MemSet (New, 0, sizeof (_DirEntry));
-                  }
+                  New = DirEntryNew (false);
                 if (DirEntryFromFilename (de->d_name, New))
                   {
                     if (New->Directory && Recurse)
@@ -308,10 +841,12 @@ void ReadDir (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack)
         closedir (Dir);
       }
     if (New)
-      free (New);
+      DirEntryFree (New);
     Depth--;
   }
 
+#endif // _Windows
+
 int GetDirLength (_DirEntry *Dir)
   {
     int Len;
@@ -328,7 +863,6 @@ int GetDirLength (_DirEntry *Dir)
 int DirSortCompareName (_DirEntry *A, _DirEntry *B)
   {
     int Result;
-    char *S1, *S2;
     //
     if (A->Directory != B->Directory)
       return (B->Directory - A->Directory);
@@ -336,12 +870,7 @@ int DirSortCompareName (_DirEntry *A, _DirEntry *B)
     if (Result)
       return Result;
     // Same so far so compare full file path
-    S1 = GetItemPath (A);
-    S2 = GetItemPath (B);
-    Result = StrCompareCase (S1, S2, false);
-    free (S1);
-    free (S2);
-    return Result;
+    return ItemPathCompareCase (A, B, false);
   }
 
 int DirSortCompareExt (_DirEntry *A, _DirEntry *B)
@@ -424,73 +953,374 @@ int DirSortCompareAttr (_DirEntry *A, _DirEntry *B)
   }
 #endif // _Windows
 
-void SortDir (_DirEntry **Dir, _SortMode Mode)
+_SortListCompare *DirSortCompareFunction (_SortMode Mode)   // NULL if Mode not supported
   {
     switch (Mode)
       {
         case sName:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortCompareName);
-          break;
+          return (_SortListCompare *) &DirSortCompareName;
         case sExt:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortCompareExt);
-          break;
+          return (_SortListCompare *) &DirSortCompareExt;
         case sPath:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortComparePath);
-          break;
+          return (_SortListCompare *) &DirSortComparePath;
         case sDateTime:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortCompareDateTime);
-          break;
+          return (_SortListCompare *) &DirSortCompareDateTime;
         case sCount:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortCompareCount);
-          break;
+          return (_SortListCompare *) &DirSortCompareCount;
         case sSize:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortCompareSize);
-          break;
+          return (_SortListCompare *) &DirSortCompareSize;
         #ifndef _Windows
         case sAttr:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortCompareAttr);
-          break;
+          return (_SortListCompare *) &DirSortCompareAttr;
         case sOwnerGroup:
-          *Dir = (_DirEntry *) SortList ((void **) *Dir, (_SortListCompare *) &DirSortCompareOwnerGroup);
-          break;
+          return (_SortListCompare *) &DirSortCompareOwnerGroup;
         #endif
       }
+    return NULL;
   }
 
-#ifndef _Windows
-  #include <sys/statvfs.h>
-#endif // _Windows
-
-bool DiskSpace (char *Path, longint *Capacity, longint *Free)
+void SortDir (_DirEntry **Dir, _SortMode Mode)
   {
-#ifdef _Windows
-    DWORD SectorsPerCluster;
-    DWORD BytesPerSector;
-    DWORD FreeClusters;
-    DWORD Clusters;
-    if (GetDiskFreeSpace (Path, &SectorsPerCluster, &BytesPerSector, &FreeClusters, &Clusters))
-      {
-        *Capacity = (longint) SectorsPerCluster * (longint) BytesPerSector * (longint) Clusters;
-        *Free = (longint) SectorsPerCluster * (longint) BytesPerSector * (longint) FreeClusters;
-        return true;
-      }
-#else
-    struct statvfs DriveStats;
+    _SortListCompare *Compare;
     //
-    if (statvfs (Path, &DriveStats) == 0)
-      {
-        *Capacity = (longint) DriveStats.f_blocks * (longint) DriveStats.f_bsize;
-        *Free = (longint) DriveStats.f_bfree * (longint) DriveStats.f_bsize;
-        return true;
-      }
-#endif // _Windows
-    return false;
+    Compare = DirSortCompareFunction (Mode);
+    if (Compare)
+      *Dir = (_DirEntry *) SortList ((void **) *Dir, Compare);
   }
 
-bool DirectoryExists (char *Path)
-  {
-    DIR *Dir;
-    //
+
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Directory Table: a list held as an array of compact records with precomputed keys
+//   Sorting is a radix sort on 64 bit keys. Runs of equal keys are refined through
+//   the stages of the sort mode (8 characters at a time for strings).
+//   Only items still tied after the last stage are compared in full.
+
+typedef struct
+  {
+    _DirEntry *Item;
+    unsigned long long NameKey;   // First 8 characters of Name, case folded
+    unsigned long long Key;   // Key for the stage being sorted
+    word NameLength;
+    word ExtOffset;   // Offset of the extension in Name
+    bool Directory;
+    bool More;   // Key was taken from a string that continues past it
+  } _DirTableEntry;
+
+typedef struct
+  {
+    int Size;
+    _DirTableEntry *Entry;
+  } _DirTable;
+
+typedef enum {dsDir, dsName, dsExt, dsPath, dsAttr, dsOwnerGroup, dsDateTime, dsCount, dsSize, dsEnd} _DirSortStage;
+
+const _DirSortStage DirSortStages [sZZZZ][4] =   // Mirrors DirSortCompare* for each _SortMode
+  {
+    {dsDir, dsName, dsEnd},            // sName
+    {dsDir, dsExt, dsName, dsEnd},     // sExt
+    {dsPath, dsDir, dsName, dsEnd},    // sPath
+    {dsAttr, dsDir, dsName, dsEnd},    // sAttr
+    {dsOwnerGroup, dsDir, dsName, dsEnd},   // sOwnerGroup
+    {dsDateTime, dsDir, dsName, dsEnd},   // sDateTime
+    {dsCount, dsDir, dsName, dsEnd},   // sCount
+    {dsSize, dsDir, dsName, dsEnd}     // sSize
+  };
+
+#define DirKeySign 0x8000000000000000ULL   // Flip to order signed values as unsigned
+
+// Order as StrCompareCase (.., false). Never 0 so a short string sorts first
+byte DirKeyChar (char c)
+  {
+    int v;
+    //
+    v = (int) UpCase (c) - CHAR_MIN;
+    if (v <= -CHAR_MIN)   // signed char: step over the terminator's place
+      v++;
+    return v;
+  }
+
+unsigned long long DirKeyString (char *St, int Length, int Depth, bool *More)
+  {
+    unsigned long long Res;
+    int i;
+    //
+    Res = 0;
+    for (i = Depth; i < Depth + 8; i++)
+      {
+        Res <<= 8;
+        if (i < Length)
+          Res |= DirKeyChar (St [i]);
+      }
+    *More = (bool) (Length > Depth + 8);
+    return Res;
+  }
+
+bool DirTableFromList (_DirTable *Table, _DirEntry *Dir)
+  {
+    _DirTableEntry *e;
+    //
+    Table->Size = GetDirLength (Dir);
+    Table->Entry = (_DirTableEntry *) malloc (sizeof (_DirTableEntry) * (Table->Size + 1));
+    if (Table->Entry == NULL)
+      {
+        Table->Size = 0;
+        return false;
+      }
+    e = Table->Entry;
+    while (Dir)
+      {
+        e->Item = Dir;
+        e->NameLength = StrLength (Dir->Name);
+        e->ExtOffset = 0;
+        if (Dir->Name)
+          e->ExtOffset = StrGetFileExtension (Dir->Name) - Dir->Name;
+        e->NameKey = DirKeyString (Dir->Name, e->NameLength, 0, &e->More);
+        e->Directory = Dir->Directory;
+        e++;
+        Dir = Dir->Next;
+      }
+    return true;
+  }
+
+// Relink the Items in Table order
+void DirTableToList (_DirTable *Table, _DirEntry **Dir)
+  {
+    int i;
+    //
+    *Dir = NULL;
+    for (i = Table->Size - 1; i >= 0; i--)
+      {
+        Table->Entry [i].Item->Next = *Dir;
+        *Dir = Table->Entry [i].Item;
+      }
+  }
+
+void DirTableFree (_DirTable *Table)   // Items are not freed
+  {
+    free (Table->Entry);
+    Table->Entry = NULL;
+    Table->Size = 0;
+  }
+
+void DirTableFillKey (_DirTableEntry *e, _DirSortStage Stage, int Depth)
+  {
+    _DirEntry *Item;
+    //
+    Item = e->Item;
+    e->More = false;
+    switch (Stage)
+      {
+        case dsDir:
+          e->Key = !e->Directory;   // Directories first
+          break;
+        case dsName:
+          if (Depth == 0)
+            {
+              e->Key = e->NameKey;
+              e->More = (bool) (e->NameLength > 8);
+            }
+          else
+            e->Key = DirKeyString (Item->Name, e->NameLength, Depth, &e->More);
+          break;
+        case dsExt:
+          e->Key = DirKeyString (Item->Name + e->ExtOffset, e->NameLength - e->ExtOffset, Depth, &e->More);
+          break;
+        case dsPath:
+          e->Key = DirKeyString (Item->Path, StrLength (Item->Path), Depth, &e->More);
+          break;
+        case dsDateTime:
+          e->Key = ~((unsigned long long) Item->DateTime ^ DirKeySign);   // Newest items first
+          break;
+        case dsCount:
+          e->Key = (unsigned long long) Item->Count ^ DirKeySign;
+          break;
+        case dsSize:
+          e->Key = (unsigned long long) Item->Size ^ DirKeySign;
+          break;
+        #ifndef _Windows
+        case dsAttr:
+          e->Key = Item->Attrib;
+          break;
+        case dsOwnerGroup:
+          e->Key = ((unsigned long long) Item->UID << 32) | Item->GID;
+          break;
+        #endif
+        default:
+          e->Key = 0;
+      }
+  }
+
+// Stable LSD radix sort on Key. Bytes the same in every Key are skipped
+void DirTableRadixSort (_DirTableEntry *Entry, _DirTableEntry *Temp, int Size)
+  {
+    int Count [8][256];
+    int Pass, i, Sum, c;
+    _DirTableEntry *Source, *Dest, *t;
+    //
+    MemSet (Count, 0, sizeof (Count));
+    for (i = 0; i < Size; i++)
+      for (Pass = 0; Pass < 8; Pass++)
+        Count [Pass][(Entry [i].Key >> (Pass * 8)) & 0xFF]++;
+    Source = Entry;
+    Dest = Temp;
+    for (Pass = 0; Pass < 8; Pass++)
+      {
+        if (Count [Pass][(Entry [0].Key >> (Pass * 8)) & 0xFF] == Size)   // nothing to do
+          continue;
+        Sum = 0;
+        for (i = 0; i < 256; i++)
+          {
+            c = Count [Pass][i];
+            Count [Pass][i] = Sum;
+            Sum += c;
+          }
+        for (i = 0; i < Size; i++)
+          Dest [Count [Pass][(Source [i].Key >> (Pass * 8)) & 0xFF]++] = Source [i];
+        t = Source;
+        Source = Dest;
+        Dest = t;
+      }
+    if (Source != Entry)
+      MemMove (Entry, Source, sizeof (_DirTableEntry) * Size);
+  }
+
+// Stable merge sort using the full compare function
+void DirTableSortCompare (_DirTableEntry *Entry, _DirTableEntry *Temp, int Size, _SortListCompare *Compare)
+  {
+    _DirTableEntry e;
+    int Half, i, j, k;
+    //
+    if (Size <= 8)   // Insertion sort
+      {
+        for (i = 1; i < Size; i++)
+          {
+            e = Entry [i];
+            j = i;
+            while (j > 0 && Compare (Entry [j - 1].Item, e.Item) > 0)
+              {
+                Entry [j] = Entry [j - 1];
+                j--;
+              }
+            Entry [j] = e;
+          }
+        return;
+      }
+    Half = Size / 2;
+    DirTableSortCompare (Entry, Temp, Half, Compare);
+    DirTableSortCompare (Entry + Half, Temp, Size - Half, Compare);
+    i = 0;
+    j = Half;
+    k = 0;
+    while (i < Half && j < Size)
+      if (Compare (Entry [j].Item, Entry [i].Item) < 0)
+        Temp [k++] = Entry [j++];
+      else
+        Temp [k++] = Entry [i++];
+    while (i < Half)
+      Temp [k++] = Entry [i++];
+    MemMove (Entry, Temp, sizeof (_DirTableEntry) * k);   // Entry [j..] are already in place
+  }
+
+void DirTableSortStage (_DirTableEntry *Entry, _DirTableEntry *Temp, int Size, _SortMode Mode, int Stage, int Depth)
+  {
+    _DirSortStage s;
+    int a, b;
+    bool More;
+    //
+    s = DirSortStages [Mode][Stage];
+    if (s == dsEnd || Size <= 8)   // Settle what is left in full
+      {
+        DirTableSortCompare (Entry, Temp, Size, DirSortCompareFunction (Mode));
+        return;
+      }
+    for (a = 0; a < Size; a++)
+      DirTableFillKey (&Entry [a], s, Depth);
+    DirTableRadixSort (Entry, Temp, Size);
+    // Refine each run of equal keys
+    a = 0;
+    while (a < Size)
+      {
+        More = Entry [a].More;
+        b = a + 1;
+        while (b < Size && Entry [b].Key == Entry [a].Key)
+          {
+            if (Entry [b].More)
+              More = true;
+            b++;
+          }
+        if (b - a > 1)
+          {
+            if (More)   // strings continue: next 8 characters
+              DirTableSortStage (Entry + a, Temp, b - a, Mode, Stage, Depth + 8);
+            else
+              DirTableSortStage (Entry + a, Temp, b - a, Mode, Stage + 1, 0);
+          }
+        a = b;
+      }
+  }
+
+void DirTableSort (_DirTable *Table, _SortMode Mode)
+  {
+    _DirTableEntry *Temp;
+    //
+    if (DirSortCompareFunction (Mode) == NULL)
+      return;
+    Temp = (_DirTableEntry *) malloc (sizeof (_DirTableEntry) * (Table->Size + 1));
+    if (Temp)
+      {
+        DirTableSortStage (Table->Entry, Temp, Table->Size, Mode, 0, 0);
+        free (Temp);
+      }
+  }
+
+// As SortDir but via a _DirTable
+void SortDirTable (_DirEntry **Dir, _SortMode Mode)
+  {
+    _DirTable Table;
+    //
+    if (DirTableFromList (&Table, *Dir))
+      {
+        DirTableSort (&Table, Mode);
+        DirTableToList (&Table, Dir);
+        DirTableFree (&Table);
+      }
+  }
+
+#ifndef _Windows
+  #include <sys/statvfs.h>
+#endif // _Windows
+
+bool DiskSpace (char *Path, longint *Capacity, longint *Free)
+  {
+#ifdef _Windows
+    DWORD SectorsPerCluster;
+    DWORD BytesPerSector;
+    DWORD FreeClusters;
+    DWORD Clusters;
+    if (GetDiskFreeSpace (Path, &SectorsPerCluster, &BytesPerSector, &FreeClusters, &Clusters))
+      {
+        *Capacity = (longint) SectorsPerCluster * (longint) BytesPerSector * (longint) Clusters;
+        *Free = (longint) SectorsPerCluster * (longint) BytesPerSector * (longint) FreeClusters;
+        return true;
+      }
+#else
+    struct statvfs DriveStats;
+    //
+    if (statvfs (Path, &DriveStats) == 0)
+      {
+        *Capacity = (longint) DriveStats.f_blocks * (longint) DriveStats.f_bsize;
+        *Free = (longint) DriveStats.f_bfree * (longint) DriveStats.f_bsize;
+        return true;
+      }
+#endif // _Windows
+    return false;
+  }
+
+bool DirectoryExists (char *Path)
+  {
+    DIR *Dir;
+    //
     Dir = opendir (Path);
     if (Dir)   // Directory exists
       {
@@ -624,17 +1454,124 @@ char *PathConfig (char **St, char *Appname)
   }
 */
 
-// Search $PATH for Filename:
-// Returns full pathname
-// Caller must free
-//
 #ifdef _Windows
   #define PathsDelimiter ';'
 #else
   #define PathsDelimiter ':'
 #endif // _Windows
+
+#ifndef _Windows
+
+////////////////////////////////////////////////////////////////////////////
 //
-char *FindFileInPath (char *Filename)
+// $PATH index for FindFileInPath
+//   Each directory in $PATH is read once, names hashed to the first directory that has them.
+//   Rebuilt when $PATH changes, or a directory's mtime has changed (looked at most
+//   every PathIndexRecheck ms). A directory changed within PathIndexRacy seconds of
+//   being read is read again at the next look, as a change in the same second can't be seen.
+
+#define PathIndexRecheck 1000
+#define PathIndexRacy 2
+
+typedef struct
+  {
+    char *Path;   // $PATH it was built from
+    char **Dir;
+    time_t *DirTime;
+    int DirCount;
+    bool Racy;
+    _HashMap Names;   // Name to the first of Dir holding it
+    int CheckNext;   // ClockMS
+  } _PathIndex;
+
+_PathIndex PathIndex;
+
+void PathIndexFree (void)
+  {
+    int i;
+    //
+    for (i = 0; i < PathIndex.DirCount; i++)
+      free (PathIndex.Dir [i]);
+    free (PathIndex.Dir);
+    free (PathIndex.DirTime);
+    free (PathIndex.Path);
+    HashMapFree (&PathIndex.Names);
+    MemSet (&PathIndex, 0, sizeof (_PathIndex));
+  }
+
+void PathIndexBuild (char *Path)
+  {
+    struct dirent *de;
+    struct stat st;
+    DIR *Dir;
+    _HashSlot *s;
+    time_t Now;
+    int a, b, d;
+    bool Added;
+    //
+    PathIndexFree ();
+    StrAssign (&PathIndex.Path, Path);
+    HashMapInit (&PathIndex.Names, true);
+    PathIndex.DirCount = StrChCount (Path, PathsDelimiter, 0) + 1;
+    PathIndex.Dir = (char **) malloc (sizeof (char *) * PathIndex.DirCount);
+    PathIndex.DirTime = (time_t *) malloc (sizeof (time_t) * PathIndex.DirCount);
+    Now = time (NULL);
+    a = -1;
+    for (d = 0; d < PathIndex.DirCount; d++)
+      {
+        b = StrPosChFrom (Path, a + 1, PathsDelimiter);
+        if (b < 0)   // no more
+          b = StrLength (Path);
+        PathIndex.Dir [d] = (char *) malloc (b - a);
+        MemMove (PathIndex.Dir [d], &Path [a + 1], b - a - 1);
+        PathIndex.Dir [d][b - a - 1] = 0;
+        a = b;
+        PathIndex.DirTime [d] = 0;
+        Dir = opendir (PathIndex.Dir [d]);
+        if (Dir == NULL)
+          continue;
+        if (fstat (dirfd (Dir), &st) == 0)
+          {
+            PathIndex.DirTime [d] = st.st_mtime;
+            if (Now - st.st_mtime < PathIndexRacy)
+              PathIndex.Racy = true;
+          }
+        while ((de = readdir (Dir)))
+          if (StrCompare (de->d_name, ".") && StrCompare (de->d_name, ".."))
+            if (de->d_type != DT_LNK || fstatat (dirfd (Dir), de->d_name, &st, 0) == 0)   // Not a dangling link
+              {
+                s = HashMapAddStr (&PathIndex.Names, de->d_name, &Added);
+                if (Added)   // Not in an earlier directory
+                  s->Value = PathIndex.Dir [d];
+              }
+        closedir (Dir);
+      }
+    PathIndex.CheckNext = ClockMS () + PathIndexRecheck;
+  }
+
+bool PathIndexValid (char *Path)
+  {
+    struct stat st;
+    int d, Now;
+    //
+    if (PathIndex.Path == NULL || StrCompare (PathIndex.Path, Path))
+      return false;
+    Now = ClockMS ();
+    if ((int) (Now - PathIndex.CheckNext) < 0)
+      return true;
+    if (PathIndex.Racy)
+      return false;
+    PathIndex.CheckNext = Now + PathIndexRecheck;
+    for (d = 0; d < PathIndex.DirCount; d++)
+      if ((stat (PathIndex.Dir [d], &st) == 0 ? st.st_mtime : 0) != PathIndex.DirTime [d])
+        return false;
+    return true;
+  }
+
+#endif // _Windows
+
+// Search $PATH for Filename, trying each directory in turn
+char *FindFileInPathScan (char *Filename)
   {
     char *Res;
     char *path;
@@ -677,6 +1614,1719 @@ char *FindFileInPath (char *Filename)
     return Res;
   }
 
+// Search $PATH for Filename:
+// Returns full pathname
+// Caller must free
+//
+char *FindFileInPath (char *Filename)
+  {
+    #ifdef _Windows
+    return FindFileInPathScan (Filename);
+    #else
+    _HashSlot *s;
+    char *Res, *path, *Dir, *p;
+    //
+    if (StrPosCh (Filename, PathDelimiter) != (unsigned int) -1)   // Not a bare name
+      return FindFileInPathScan (Filename);
+    path = getenv ("PATH");
+    if (path == NULL || path [0] == 0)
+      return NULL;
+    if (!PathIndexValid (path))
+      PathIndexBuild (path);
+    s = HashMapFindStr (&PathIndex.Names, Filename);
+    if (s == NULL)
+      return NULL;
+    Dir = (char *) s->Value;
+    Res = (char *) malloc (StrLength (Dir) + StrLength (Filename) + 2);
+    p = StrCopy (Res, Dir);
+    *p++ = PathDelimiter;
+    StrCopy (p, Filename);
+    return Res;
+    #endif // _Windows
+  }
+
+
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Directory Cache: ReadDir with listings kept on disk between runs
+//   One file per directory in the DirCache folder of StrPathConfig (AppName),
+//   named by device & inode. A listing is reused while the directory's mtime &
+//   ctime are unchanged, which catches entries added, removed or renamed.
+//   (A file changed in place is not seen until its directory changes.)
+//   Each listing also holds the Count & Size of regular files in the tree below it.
+//   A listing's file time is when it was last used (refreshed at most daily). Once a
+//   day, listings unused for DirCacheExpiry go, then the least recently used until
+//   the folder is within DirCacheMaxSize.
+
+#ifndef _Windows
+
+#define DirCacheMagic 0x31434444   // "DDC1"
+#define DirCacheRacy 2   // Seconds. Don't cache a directory changed this recently
+#define DirCacheTouch (24 * 3600)   // Seconds between refreshing a used listing's time
+#define DirCachePruneEvery (24 * 3600)
+#define DirCacheExpiry (30 * 24 * 3600)
+#define DirCacheMaxSize 0x4000000   // 64 MB
+#define DirCachePruned ".Pruned"   // Its time is the last prune
+
+typedef struct
+  {
+    unsigned int Magic;
+    unsigned int Entries;
+    longint Dev, Ino;
+    longint MTime, CTime;
+    longint Count, Size;   // Regular files in the tree below. -1: not known
+  } _DirCacheHeader;
+
+typedef struct   // Followed by Name and SymLinkTarget (not terminated)
+  {
+    longint Size;
+    longint DateTime;
+    unsigned int Attrib;
+    unsigned int UID, GID;
+    word NameLength;
+    word TargetLength;
+    byte Directory;
+    byte SymLink;
+  } _DirCacheRecord;
+
+typedef struct
+  {
+    _DirCacheHeader Header;
+    byte *Data;   // _DirCacheRecords
+    unsigned int Size;
+    unsigned int SizeAllocated;
+    time_t Used;   // The file's mtime when read
+    bool Failed;   // Out of memory adding a record: the listing is incomplete
+  } _DirCache;
+
+void DirCacheInit (_DirCache *Cache)
+  {
+    MemSet (Cache, 0, sizeof (_DirCache));
+    Cache->Header.Magic = DirCacheMagic;
+    Cache->Header.Count = -1;
+    Cache->Header.Size = -1;
+  }
+
+void DirCacheFree (_DirCache *Cache)
+  {
+    free (Cache->Data);
+    DirCacheInit (Cache);
+  }
+
+void DirCacheFilename (char *Filename, char *CacheDir, longint Dev, longint Ino)
+  {
+    char *p;
+    //
+    p = Filename;
+    StrToStr (&p, CacheDir);
+    CharToStr (&p, PathDelimiter);
+    IntToHex (&p, Dev, 0);
+    CharToStr (&p, '-');
+    IntToHex (&p, Ino, 0);
+    *p = 0;
+  }
+
+bool DirCacheRead (char *Filename, _DirCache *Cache)
+  {
+    struct stat st;
+    int f;
+    longint Size;
+    bool OK;
+    //
+    DirCacheInit (Cache);
+    OK = false;
+    f = FileOpen (Filename, foRead);
+    if (f >= 0)
+      {
+        if (fstat (f, &st) == 0)
+          Cache->Used = st.st_mtime;
+        Size = lseek (f, 0, SEEK_END) - sizeof (_DirCacheHeader);
+        lseek (f, 0, SEEK_SET);
+        if (Size >= 0 && read (f, &Cache->Header, sizeof (_DirCacheHeader)) == sizeof (_DirCacheHeader))
+          if (Cache->Header.Magic == DirCacheMagic)
+            {
+              Cache->Data = (byte *) malloc (Size + 1);
+              Cache->Size = Cache->SizeAllocated = Size;
+              if (Cache->Data && read (f, Cache->Data, Size) == Size)
+                OK = true;
+            }
+        close (f);
+      }
+    if (!OK)
+      DirCacheFree (Cache);
+    return OK;
+  }
+
+bool DirCacheWrite (char *Filename, _DirCache *Cache)
+  {
+    char *Temp;
+    int f;
+    bool OK;
+    //
+    OK = false;
+    Temp = (char *) malloc (StrLength (Filename) + 5);
+    StrCopy (StrCopy (Temp, Filename), ".new");
+    f = FileOpen (Temp, foWrite);
+    if (f >= 0)
+      {
+        if (write (f, &Cache->Header, sizeof (_DirCacheHeader)) == sizeof (_DirCacheHeader))
+          if (write (f, Cache->Data, Cache->Size) == Cache->Size)
+            OK = true;
+        close (f);
+        if (OK)   // Replace old listing in one step
+          OK = (bool) (rename (Temp, Filename) == 0);
+        if (!OK)
+          unlink (Temp);
+      }
+    free (Temp);
+    return OK;
+  }
+
+void DirCacheAdd (_DirCache *Cache, _DirEntry *Item)
+  {
+    _DirCacheRecord r;
+    unsigned int Size;
+    byte *d;
+    //
+    MemSet (&r, 0, sizeof (r));
+    r.Size = Item->Size;
+    r.DateTime = Item->DateTime;
+    r.Attrib = Item->Attrib;
+    r.UID = Item->UID;
+    r.GID = Item->GID;
+    r.NameLength = StrLength (Item->Name);
+    r.TargetLength = StrLength (Item->SymLinkTarget);
+    r.Directory = Item->Directory;
+    r.SymLink = Item->SymLink;
+    Size = Cache->Size + sizeof (r) + r.NameLength + r.TargetLength;
+    if (Size > Cache->SizeAllocated)
+      {
+        d = (byte *) realloc (Cache->Data, Size * 2);
+        if (d == NULL)
+          {
+            Cache->Failed = true;
+            return;
+          }
+        Cache->Data = d;
+        Cache->SizeAllocated = Size * 2;
+      }
+    d = Cache->Data + Cache->Size;
+    MemMove (d, &r, sizeof (r));
+    MemMove (d + sizeof (r), Item->Name, r.NameLength);
+    MemMove (d + sizeof (r) + r.NameLength, Item->SymLinkTarget, r.TargetLength);
+    Cache->Size = Size;
+    Cache->Header.Entries++;
+  }
+
+char *DirCacheString (byte *Data, int Length)   // Caller must free Result
+  {
+    char *Res;
+    //
+    Res = (char *) malloc (Length + 1);
+    MemMove (Res, Data, Length);
+    Res [Length] = 0;
+    return Res;
+  }
+
+// Next Item from Cache at *Pos. NULL at the end
+_DirEntry *DirCacheNext (_DirCache *Cache, unsigned int *Pos, char *Path, bool Pooled)
+  {
+    _DirCacheRecord r;
+    _DirEntry *Item;
+    byte *d;
+    //
+    if (*Pos + sizeof (r) > Cache->Size)
+      return NULL;
+    d = Cache->Data + *Pos;
+    MemMove (&r, d, sizeof (r));
+    if (*Pos + sizeof (r) + r.NameLength + r.TargetLength > Cache->Size)   // truncated
+      return NULL;
+    *Pos += sizeof (r) + r.NameLength + r.TargetLength;
+    Item = DirEntryNew (Pooled);
+    StrAssign (&Item->Path, Path);
+    Item->Name = DirCacheString (d + sizeof (r), r.NameLength);
+    if (r.TargetLength)
+      Item->SymLinkTarget = DirCacheString (d + sizeof (r) + r.NameLength, r.TargetLength);
+    Item->Directory = (bool) r.Directory;
+    Item->SymLink = (bool) r.SymLink;
+    Item->Size = r.Size;
+    Item->DateTime = r.DateTime;
+    Item->Attrib = r.Attrib;
+    Item->UID = r.UID;
+    Item->GID = r.GID;
+    return Item;
+  }
+
+// Read the directory open on DirFd (closed here) whose full path is Path.
+// Scan gives cancel, progress, Pooled and MaxEntries/Deadline as for ReadDirScan (not Filter or MaxDepth)
+void ReadDirCached_ (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack, _ReadDirScan *Scan, char *CacheDir,
+                     int DirFd, char *Path, longint *TreeCount, longint *TreeSize)
+  {
+    struct stat st;
+    _DirCache Cache;
+    _DirEntry *Local, **Tail, *New;
+    struct dirent *de;
+    DIR *Dir;
+    char *Filename, *SubPath;
+    unsigned int Pos;
+    bool Valid, Listed, Known;
+    byte Res;
+    longint Count, Size, SubCount, SubSize;
+    int TotalCount_, SubFd, Fd;
+    longint TotalSize_;
+    time_t Changed;
+    //
+    *TreeCount = *TreeSize = -1;
+    if (fstat (DirFd, &st) != 0)
+      {
+        close (DirFd);
+        return;
+      }
+    Scan->Depth++;
+    Filename = (char *) malloc (MaxPath);
+    DirCacheFilename (Filename, CacheDir, st.st_dev, st.st_ino);
+    Valid = DirCacheRead (Filename, &Cache);
+    if (Valid)
+      Valid = (bool) (Cache.Header.Dev == (longint) st.st_dev && Cache.Header.Ino == (longint) st.st_ino &&
+                      Cache.Header.MTime == st.st_mtime && Cache.Header.CTime == st.st_ctime);
+    // Gather the listing: from the cache or from the directory
+    Local = NULL;
+    Tail = &Local;
+    Listed = false;
+    if (Valid)
+      {
+        Pos = 0;
+        while ((New = DirCacheNext (&Cache, &Pos, Path, Scan->Pooled)))
+          {
+            *Tail = New;
+            Tail = &New->Next;
+          }
+      }
+    else
+      {
+        DirCacheFree (&Cache);
+        Cache.Header.Dev = st.st_dev;
+        Cache.Header.Ino = st.st_ino;
+        Cache.Header.MTime = st.st_mtime;
+        Cache.Header.CTime = st.st_ctime;
+        Fd = dup (DirFd);   // fdopendir takes it, DirFd is still needed for the subdirectories
+        Dir = Fd >= 0 ? fdopendir (Fd) : NULL;
+        if (Dir)
+          {
+            while ((de = readdir (Dir)))
+              if (StrCompare (de->d_name, ".") && StrCompare (de->d_name, ".."))
+                {
+                  New = DirEntryNew (Scan->Pooled);
+                  if (DirEntryFromFilenameAt (DirFd, Path, de->d_name, New))
+                    {
+                      DirCacheAdd (&Cache, New);
+                      *Tail = New;
+                      Tail = &New->Next;
+                    }
+                  else
+                    DirEntryFree (New);
+                }
+            closedir (Dir);
+            Listed = true;
+          }
+        else if (Fd >= 0)
+          close (Fd);
+      }
+    // Process the listing as ReadDirScan does
+    Count = Size = 0;
+    Known = true;
+    while (Local)
+      {
+        New = Local;
+        Local = New->Next;
+        New->Next = NULL;
+        Scan->Path = Path;
+        if (Scan->Stopped || ReadDirScanStop (Scan))
+          {
+            DirEntryFree (New);
+            continue;
+          }
+        Scan->Entries++;
+        if (S_ISREG (New->Attrib))
+          {
+            Count++;
+            Size += New->Size;
+          }
+        if (New->Directory)
+          {
+            SubFd = -1;
+            if (Recurse)
+              SubFd = openat (DirFd, New->Name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (SubFd >= 0)
+              {
+                SubPath = GetItemPath (New);
+                TotalCount_ = Scan->TotalCount;
+                TotalSize_ = Scan->TotalSize;
+                ReadDirCached_ (List, Recurse, CallBack, Scan, CacheDir, SubFd, SubPath, &SubCount, &SubSize);
+                New->Count = Scan->TotalCount - TotalCount_;
+                New->Size = Scan->TotalSize - TotalSize_;
+                free (SubPath);
+                if (SubCount >= 0)
+                  {
+                    Count += SubCount;
+                    Size += SubSize;
+                  }
+                else
+                  Known = false;
+              }
+            else if (!Recurse)
+              Known = false;
+          }
+        Res = ReadDirInList | ReadDirInStats;
+        if (CallBack)
+          Res = CallBack (New, Scan->Depth);
+        if (Res & ReadDirInStats)
+          if (S_ISREG (New->Attrib))
+            {
+              Scan->TotalCount++;
+              Scan->TotalSize += New->Size;
+            }
+        if (Res & ReadDirInList)   // Add to top of list
+          {
+            New->Next = *List;
+            *List = New;
+          }
+        else
+          DirEntryFree (New);
+      }
+    // Update the cache
+    if (!Scan->Stopped && (Valid || Listed))
+      {
+        if (!Known)   // Keep totals from the last full scan
+          {
+            Count = Cache.Header.Count;
+            Size = Cache.Header.Size;
+          }
+        Changed = st.st_mtime > st.st_ctime ? st.st_mtime : st.st_ctime;
+        if (!Cache.Failed && (!Valid || Count != Cache.Header.Count || Size != Cache.Header.Size))
+          if (time (NULL) - Changed >= DirCacheRacy)
+            {
+              Cache.Header.Count = Count;
+              Cache.Header.Size = Size;
+              DirCacheWrite (Filename, &Cache);
+              Cache.Used = time (NULL);
+            }
+        if (Valid && time (NULL) - Cache.Used >= DirCacheTouch)   // Still in use: keep it from expiring
+          utime (Filename, NULL);
+        *TreeCount = Count;
+        *TreeSize = Size;
+      }
+    DirCacheFree (&Cache);
+    free (Filename);
+    close (DirFd);
+    Scan->Depth--;
+  }
+
+typedef struct
+  {
+    char *Name;
+    time_t Used;
+    longint Size;
+  } _DirCacheFile;
+
+int DirCacheFileCompare (const void *A, const void *B)   // Least recently used first
+  {
+    time_t a, b;
+    //
+    a = ((_DirCacheFile *) A)->Used;
+    b = ((_DirCacheFile *) B)->Used;
+    return (a > b) - (a < b);
+  }
+
+// Remove listings unused for DirCacheExpiry, then the oldest beyond DirCacheMaxSize.
+// Does nothing if done within DirCachePruneEvery
+void DirCachePrune (char *CacheDir)
+  {
+    struct stat st;
+    struct dirent *de;
+    DIR *Dir;
+    _DirCacheFile *File, *f;
+    char *Filename, *Name;
+    int Count, Allocated, i, Length;
+    longint Total;
+    time_t Now;
+    //
+    Now = time (NULL);
+    Filename = (char *) malloc (MaxPath);
+    Length = StrLength (CacheDir);
+    Name = StrCopy (Filename, CacheDir);
+    *Name++ = PathDelimiter;
+    StrCopy (Name, DirCachePruned);
+    if (stat (Filename, &st) == 0 && Now - st.st_mtime < DirCachePruneEvery)
+      {
+        free (Filename);
+        return;
+      }
+    close (FileOpen (Filename, foWrite));   // Mark it done, even if it goes wrong below
+    File = NULL;
+    Count = Allocated = 0;
+    Total = 0;
+    Dir = opendir (CacheDir);
+    if (Dir)
+      {
+        while ((de = readdir (Dir)))
+          if (de->d_name [0] != '.' && Length + StrLength (de->d_name) + 2 <= MaxPath)
+            {
+              StrCopy (Name, de->d_name);
+              if (stat (Filename, &st) != 0 || !S_ISREG (st.st_mode))
+                continue;
+              if (Now - st.st_mtime >= DirCacheExpiry)
+                {
+                  unlink (Filename);
+                  continue;
+                }
+              if (Count >= Allocated)
+                {
+                  Allocated = Allocated ? Allocated * 2 : 256;
+                  f = (_DirCacheFile *) realloc (File, sizeof (_DirCacheFile) * Allocated);
+                  if (f == NULL)
+                    break;
+                  File = f;
+                }
+              File [Count].Name = NULL;
+              StrAssign (&File [Count].Name, de->d_name);
+              File [Count].Used = st.st_mtime;
+              File [Count].Size = st.st_size;
+              Total += st.st_size;
+              Count++;
+            }
+        closedir (Dir);
+      }
+    if (Total > DirCacheMaxSize)
+      {
+        qsort (File, Count, sizeof (_DirCacheFile), DirCacheFileCompare);
+        for (i = 0; i < Count && Total > DirCacheMaxSize; i++)
+          {
+            StrCopy (Name, File [i].Name);
+            if (unlink (Filename) == 0)
+              Total -= File [i].Size;
+          }
+      }
+    for (i = 0; i < Count; i++)
+      free (File [i].Name);
+    free (File);
+    free (Filename);
+  }
+
+// As ReadDirScan (of the current directory), using and updating the cache for AppName
+void ReadDirCachedScan (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack, _ReadDirScan *Scan, char *AppName)
+  {
+    longint Count, Size;
+    char *CacheDir, *FullPath, *p;
+    int DirFd;
+    //
+    FullPath = realpath (".", NULL);
+    DirFd = open (".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (FullPath == NULL || DirFd < 0)
+      {
+        if (DirFd >= 0)
+          close (DirFd);
+        free (FullPath);
+        return;
+      }
+    CacheDir = (char *) malloc (MaxPath);
+    p = CacheDir;
+    StrPathConfig (&p, (char *) "DirCache", AppName);
+    if (!DirectoryExists (CacheDir))
+      MakePath (CacheDir);
+    Scan->ClockCountdown = 0;
+    Scan->ProgressNext = ClockMS () + Scan->ProgressInterval;
+    ReadDirCached_ (List, Recurse, CallBack, Scan, CacheDir, DirFd, FullPath, &Count, &Size);
+    Scan->Path = NULL;
+    if (!Scan->Stopped)
+      DirCachePrune (CacheDir);
+    free (CacheDir);
+    free (FullPath);
+  }
+
+// As ReadDir, using and updating the cache for AppName
+void ReadDirCached (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack, char *AppName)
+  {
+    _ReadDirScan Scan;
+    //
+    ReadDirScanInit (&Scan);
+    Scan.Progress = ReadDirEscape;
+    Scan.ProgressInterval = 50;
+    ReadDirCachedScan (List, Recurse, CallBack, &Scan, AppName);
+  }
+
+// Count & Size of regular files in the tree below Path, as of its last cached scan
+bool DirCacheTotals (char *Path, char *AppName, longint *Count, longint *Size)
+  {
+    struct stat st;
+    _DirCache Cache;
+    char *CacheDir, *Filename, *p;
+    bool OK;
+    //
+    OK = false;
+    if (stat (Path, &st) == 0)
+      {
+        CacheDir = (char *) malloc (MaxPath);
+        Filename = (char *) malloc (MaxPath);
+        p = CacheDir;
+        StrPathConfig (&p, (char *) "DirCache", AppName);
+        DirCacheFilename (Filename, CacheDir, st.st_dev, st.st_ino);
+        if (DirCacheRead (Filename, &Cache))
+          {
+            if (Cache.Header.MTime == st.st_mtime && Cache.Header.CTime == st.st_ctime && Cache.Header.Count >= 0)
+              {
+                *Count = Cache.Header.Count;
+                *Size = Cache.Header.Size;
+                OK = true;
+              }
+            DirCacheFree (&Cache);
+          }
+        free (Filename);
+        free (CacheDir);
+      }
+    return OK;
+  }
+
+#else
+
+void ReadDirCached (_DirEntry **List, bool Recurse, _ReadDirCallback CallBack, char *AppName)
+  {
+    ReadDir (List, Recurse, CallBack);
+  }
+
+bool DirCacheTotals (char *Path, char *AppName, longint *Count, longint *Size)
+  {
+    return false;
+  }
+
+#endif // _Windows
+
+
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Directory Watch: Keep a list read by ReadDir current using inotify
+//   DirWatchAttach () watches every directory in the list. DirWatchPoll () applies
+//   create, delete, rename and modify events to the list and keeps the Count & Size
+//   of regular files below each directory up to date along the parent chain.
+//   Directories that can't be watched (eg the inotify watch limit is reached) are
+//   counted in Unwatched, and Overflow is set if events were lost. In either case
+//   the caller should fall back to rescanning.
+//   Items maps each entry's full path to the entry before it in the list, so an event
+//   finds and unlinks its entry without walking the list. The list must only be
+//   changed by DirWatchPoll while attached.
+
+#ifndef _Windows
+
+#include <sys/inotify.h>
+
+#define DirWatchMask (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_ONLYDIR | IN_DONT_FOLLOW)
+
+typedef struct DirWatchDir
+  {
+    char *Path;   // Full path
+    _DirEntry *Item;   // Its entry in the list. NULL for the root
+    struct DirWatchDir *Parent;
+    int Wd;   // inotify watch descriptor. -1 if not watched
+  } _DirWatchDir;
+
+typedef struct
+  {
+    int Fd;   // inotify instance. May be polled by the caller
+    _DirWatchDir **Dir;   // Sorted by Path
+    int DirSize;
+    int DirAllocated;
+    _DirWatchDir **ByWd;   // Indexed by watch descriptor
+    int ByWdSize;
+    longint Count;   // Regular files below the root
+    longint Size;
+    int Unwatched;   // Directories not watched
+    bool Overflow;   // Events were lost
+    _HashMap Items;   // Full path of each entry to the one before it (NULL: the first)
+  } _DirWatch;
+
+_DirWatchDir *DirWatchFind (_DirWatch *Watch, char *Path, int *Index)   // Binary search. Index: where it is or should be
+  {
+    int a, b, m, c;
+    //
+    a = 0;
+    b = Watch->DirSize;
+    while (a < b)
+      {
+        m = (a + b) / 2;
+        c = StrCompare (Watch->Dir [m]->Path, Path);
+        if (c == 0)
+          {
+            a = m;
+            break;
+          }
+        if (c < 0)
+          a = m + 1;
+        else
+          b = m;
+      }
+    if (Index)
+      *Index = a;
+    if (a < Watch->DirSize && StrCompare (Watch->Dir [a]->Path, Path) == 0)
+      return Watch->Dir [a];
+    return NULL;
+  }
+
+// Add a directory and watch it. Path becomes the record's
+_DirWatchDir *DirWatchAdd (_DirWatch *Watch, char *Path, _DirEntry *Item)
+  {
+    _DirWatchDir *d, **a;
+    int i, n;
+    //
+    d = DirWatchFind (Watch, Path, &i);
+    if (d)
+      {
+        free (Path);
+        d->Item = Item;
+        return d;
+      }
+    if (Watch->DirSize >= Watch->DirAllocated)
+      {
+        n = Watch->DirAllocated * 2 + 16;
+        a = (_DirWatchDir **) realloc (Watch->Dir, sizeof (_DirWatchDir *) * n);
+        if (a == NULL)
+          {
+            free (Path);
+            return NULL;
+          }
+        Watch->Dir = a;
+        Watch->DirAllocated = n;
+      }
+    d = (_DirWatchDir *) malloc (sizeof (_DirWatchDir));
+    d->Path = Path;
+    d->Item = Item;
+    d->Parent = NULL;
+    d->Wd = -1;
+    MemMove (&Watch->Dir [i + 1], &Watch->Dir [i], sizeof (_DirWatchDir *) * (Watch->DirSize - i));
+    Watch->Dir [i] = d;
+    Watch->DirSize++;
+    if (Watch->Fd >= 0)
+      d->Wd = inotify_add_watch (Watch->Fd, Path, DirWatchMask);
+    if (d->Wd >= 0)
+      {
+        if (d->Wd >= Watch->ByWdSize)
+          {
+            n = d->Wd * 2 + 16;
+            a = (_DirWatchDir **) realloc (Watch->ByWd, sizeof (_DirWatchDir *) * n);
+            if (a)
+              {
+                MemSet (&a [Watch->ByWdSize], 0, sizeof (_DirWatchDir *) * (n - Watch->ByWdSize));
+                Watch->ByWd = a;
+                Watch->ByWdSize = n;
+              }
+          }
+        if (d->Wd < Watch->ByWdSize)
+          Watch->ByWd [d->Wd] = d;
+      }
+    else
+      Watch->Unwatched++;
+    return d;
+  }
+
+void DirWatchRemove (_DirWatch *Watch, int Index)
+  {
+    _DirWatchDir *d;
+    //
+    d = Watch->Dir [Index];
+    if (d->Wd >= 0)
+      {
+        inotify_rm_watch (Watch->Fd, d->Wd);
+        if (d->Wd < Watch->ByWdSize)
+          Watch->ByWd [d->Wd] = NULL;
+      }
+    MemMove (&Watch->Dir [Index], &Watch->Dir [Index + 1], sizeof (_DirWatchDir *) * (Watch->DirSize - Index - 1));
+    Watch->DirSize--;
+    free (d->Path);
+    free (d);
+  }
+
+// Watch the directories in List and link each to its parent
+void DirWatchAddList (_DirWatch *Watch, _DirEntry *List)
+  {
+    _DirEntry *Item;
+    _DirWatchDir *d;
+    int i;
+    //
+    for (Item = List; Item; Item = Item->Next)
+      if (Item->Directory)
+        DirWatchAdd (Watch, GetItemPath (Item), Item);
+    for (i = 0; i < Watch->DirSize; i++)
+      {
+        d = Watch->Dir [i];
+        if (d->Item && d->Parent == NULL)
+          d->Parent = DirWatchFind (Watch, d->Item->Path, NULL);
+      }
+  }
+
+// Is Path Dir or within it?
+bool DirWatchBelow (char *Path, char *Dir, int DirLength)
+  {
+    int i;
+    //
+    if (Path == NULL)
+      return false;
+    for (i = 0; i < DirLength; i++)
+      if (Path [i] != Dir [i])
+        return false;
+    return (bool) (Path [i] == 0 || Path [i] == PathDelimiter);
+  }
+
+void DirWatchAdjust (_DirWatch *Watch, _DirWatchDir *Dir, longint Count, longint Size)
+  {
+    while (Dir)
+      {
+        if (Dir->Item)
+          {
+            Dir->Item->Count += Count;
+            Dir->Item->Size += Size;
+          }
+        else
+          {
+            Watch->Count += Count;
+            Watch->Size += Size;
+          }
+        Dir = Dir->Parent;
+      }
+  }
+
+char *DirWatchKey (char *Path, char *Name)   // As GetItemPathFrom. Caller must free Result
+  {
+    _DirEntry Item;
+    //
+    Item.Name = Name;
+    return GetItemPathFrom (Path, &Item);
+  }
+
+void DirWatchSetPrev (_DirWatch *Watch, _DirEntry *Item, _DirEntry *Prev)
+  {
+    _HashSlot *s;
+    char *Key;
+    //
+    Key = GetItemPath (Item);
+    s = HashMapAddStr (&Watch->Items, Key, NULL);
+    if (s)
+      s->Value = Prev;
+    free (Key);
+  }
+
+_DirEntry **DirWatchFindItem (_DirWatch *Watch, _DirEntry **List, char *Path, char *Name, _DirEntry **Prev)   // Returns the link to the Item
+  {
+    _HashSlot *s;
+    char *Key;
+    //
+    Key = DirWatchKey (Path, Name);
+    s = HashMapFindStr (&Watch->Items, Key);
+    free (Key);
+    if (s == NULL)
+      return NULL;
+    if (Prev)
+      *Prev = (_DirEntry *) s->Value;
+    return s->Value ? &((_DirEntry *) s->Value)->Next : List;
+  }
+
+void DirWatchPush (_DirWatch *Watch, _DirEntry **List, _DirEntry *Item)   // Onto the top of List
+  {
+    Item->Next = *List;
+    if (*List)
+      DirWatchSetPrev (Watch, *List, Item);
+    *List = Item;
+    DirWatchSetPrev (Watch, Item, NULL);
+  }
+
+_DirEntry *DirWatchUnlink (_DirWatch *Watch, _DirEntry **Link, _DirEntry *Prev)   // Take *Link, which follows Prev, out of the list
+  {
+    _DirEntry *Item;
+    char *Key;
+    //
+    Item = *Link;
+    *Link = Item->Next;
+    if (Item->Next)
+      DirWatchSetPrev (Watch, Item->Next, Prev);
+    Key = GetItemPath (Item);
+    HashMapRemoveStr (&Watch->Items, Key);
+    free (Key);
+    return Item;
+  }
+
+int DirWatchDelete (_DirWatch *Watch, _DirEntry **List, _DirWatchDir *Dir, char *Name)
+  {
+    _DirEntry **Link, *Item, *Prev;
+    char *Path;
+    int l, i;
+    //
+    Link = DirWatchFindItem (Watch, List, Dir->Path, Name, &Prev);
+    if (Link == NULL)
+      return 0;
+    Item = DirWatchUnlink (Watch, Link, Prev);
+    if (Item->Directory)
+      {
+        DirWatchAdjust (Watch, Dir, -Item->Count, -Item->Size);
+        Path = GetItemPath (Item);
+        l = StrLength (Path);
+        // Drop everything below it
+        Link = List;
+        Prev = NULL;
+        while (*Link)
+          if (DirWatchBelow ((*Link)->Path, Path, l))
+            DirEntryFree (DirWatchUnlink (Watch, Link, Prev));
+          else
+            {
+              Prev = *Link;
+              Link = &(*Link)->Next;
+            }
+        for (i = Watch->DirSize - 1; i >= 0; i--)
+          if (DirWatchBelow (Watch->Dir [i]->Path, Path, l))
+            DirWatchRemove (Watch, i);
+        free (Path);
+      }
+    else if (S_ISREG (Item->Attrib))
+      DirWatchAdjust (Watch, Dir, -1, -Item->Size);
+    DirEntryFree (Item);
+    return 1;
+  }
+
+int DirWatchUpdate (_DirWatch *Watch, _DirEntry **List, _DirWatchDir *Dir, char *Name)
+  {
+    _DirEntry **Link, *Item, New;
+    char *Path, *p;
+    bool Reg, Reg_;
+    int Res;
+    //
+    Link = DirWatchFindItem (Watch, List, Dir->Path, Name, NULL);
+    if (Link == NULL)
+      return 0;
+    Item = *Link;
+    Res = 0;
+    Path = GetItemPath (Item);
+    MemSet (&New, 0, sizeof (_DirEntry));
+    if (DirEntryFromFilename (Path, &New) && New.Directory == Item->Directory)
+      {
+        if (!Item->Directory)   // (a directory's Size is what is below it)
+          {
+            Reg = (bool) (S_ISREG (New.Attrib) != 0);
+            Reg_ = (bool) (S_ISREG (Item->Attrib) != 0);
+            DirWatchAdjust (Watch, Dir, (longint) Reg - (longint) Reg_, (Reg ? New.Size : 0) - (Reg_ ? Item->Size : 0));
+            Item->Size = New.Size;
+          }
+        Item->SymLink = New.SymLink;
+        Item->DateTime = New.DateTime;
+        Item->Attrib = New.Attrib;
+        Item->UID = New.UID;
+        Item->GID = New.GID;
+        p = Item->SymLinkTarget;
+        Item->SymLinkTarget = New.SymLinkTarget;
+        New.SymLinkTarget = p;
+        Res = 1;
+      }
+    FreeDirItemContents (&New);
+    free (Path);
+    return Res;
+  }
+
+int DirWatchCreate (_DirWatch *Watch, _DirEntry **List, _DirWatchDir *Dir, char *Name)
+  {
+    _DirEntry *New, *Sub, *Item;
+    _ReadDirScan Scan;
+    char *Path;
+    //
+    if (DirWatchFindItem (Watch, List, Dir->Path, Name, NULL))   // already seen
+      return DirWatchUpdate (Watch, List, Dir, Name);
+    New = DirEntryNew (false);
+    StrAssign (&New->Name, Name);
+    Path = GetItemPathFrom (Dir->Path, New);
+    if (!DirEntryFromFilename (Path, New))   // gone again
+      {
+        DirEntryFree (New);
+        free (Path);
+        return 0;
+      }
+    StrAssign (&New->Path, Dir->Path);
+    StrAssign (&New->Name, Name);
+    DirWatchPush (Watch, List, New);
+    if (New->Directory)   // Watch it first, then read what is already in it
+      {
+        New->Count = 0;
+        New->Size = 0;
+        DirWatchAdd (Watch, Path, New);
+        Sub = NULL;
+        ReadDirScanInit (&Scan);   // No Progress: keys are the caller's, the listing whole
+        ReadDirScan (&Sub, true, NULL, &Scan, Path);
+        DirWatchAddList (Watch, Sub);
+        while (Sub)   // Move Sub onto List
+          {
+            Item = Sub;
+            Sub = Item->Next;
+            if (S_ISREG (Item->Attrib))
+              {
+                New->Count++;
+                New->Size += Item->Size;
+              }
+            DirWatchPush (Watch, List, Item);
+          }
+        DirWatchAdjust (Watch, Dir, New->Count, New->Size);
+      }
+    else
+      {
+        if (S_ISREG (New->Attrib))
+          DirWatchAdjust (Watch, Dir, 1, New->Size);
+        free (Path);
+      }
+    return 1;
+  }
+
+int DirWatchEvent (_DirWatch *Watch, _DirEntry **List, struct inotify_event *Event)
+  {
+    _DirWatchDir *Dir;
+    //
+    if (Event->mask & IN_Q_OVERFLOW)
+      {
+        Watch->Overflow = true;
+        return 0;
+      }
+    if (Event->wd < 0 || Event->wd >= Watch->ByWdSize)
+      return 0;
+    Dir = Watch->ByWd [Event->wd];
+    if (Dir == NULL)
+      return 0;
+    if (Event->mask & IN_IGNORED)   // watch gone
+      {
+        Watch->ByWd [Event->wd] = NULL;
+        Dir->Wd = -1;
+        return 0;
+      }
+    if (Event->len == 0)   // about the directory itself
+      return 0;
+    if (Event->mask & (IN_DELETE | IN_MOVED_FROM))
+      return DirWatchDelete (Watch, List, Dir, Event->name);
+    if (Event->mask & (IN_CREATE | IN_MOVED_TO))
+      return DirWatchCreate (Watch, List, Dir, Event->name);
+    return DirWatchUpdate (Watch, List, Dir, Event->name);
+  }
+
+// Watch List as read by ReadDir in Root (NULL: the current directory)
+bool DirWatchAttach (_DirWatch *Watch, _DirEntry *List, char *Root)
+  {
+    _DirEntry *Item, *Prev;
+    char *Path;
+    //
+    MemSet (Watch, 0, sizeof (_DirWatch));
+    HashMapInit (&Watch->Items, true);
+    Watch->Fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
+    Path = realpath (Root ? Root : ".", NULL);   // As the list's paths: absolute, no trailing delimiter
+    if (Path == NULL)
+      {
+        if (Watch->Fd >= 0)
+          close (Watch->Fd);
+        Watch->Fd = -1;
+        return false;
+      }
+    DirWatchAdd (Watch, Path, NULL);
+    DirWatchAddList (Watch, List);
+    Prev = NULL;
+    for (Item = List; Item; Item = Item->Next)
+      {
+        DirWatchSetPrev (Watch, Item, Prev);
+        Prev = Item;
+        if (S_ISREG (Item->Attrib))
+          {
+            Watch->Count++;
+            Watch->Size += Item->Size;
+          }
+      }
+    return (bool) (Watch->Fd >= 0);
+  }
+
+// Apply pending events to *List. Does not wait. Returns how many changed it
+int DirWatchPoll (_DirWatch *Watch, _DirEntry **List)
+  {
+    union
+      {
+        struct inotify_event Event;
+        char Data [4096];
+      } Buffer;
+    struct inotify_event *Event, *Prev;
+    int Len, i, Res;
+    //
+    Res = 0;
+    if (Watch->Fd >= 0)
+      while (true)
+        {
+          Len = read (Watch->Fd, Buffer.Data, sizeof (Buffer));
+          if (Len <= 0)
+            break;
+          Prev = NULL;
+          for (i = 0; i < Len; i += sizeof (struct inotify_event) + Event->len)
+            {
+              Event = (struct inotify_event *) &Buffer.Data [i];
+              if (Prev && (Event->mask & (IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE)) && Prev->mask == Event->mask &&
+                  Prev->wd == Event->wd && StrCompare (Prev->len ? Prev->name : (char *) StrNull, Event->len ? Event->name : (char *) StrNull) == 0)
+                continue;   // repeated: once is enough
+              Res += DirWatchEvent (Watch, List, Event);
+              Prev = Event;
+            }
+        }
+    return Res;
+  }
+
+void DirWatchClose (_DirWatch *Watch)   // The list is left as it is
+  {
+    while (Watch->DirSize)
+      DirWatchRemove (Watch, Watch->DirSize - 1);
+    if (Watch->Fd >= 0)
+      close (Watch->Fd);
+    Watch->Fd = -1;
+    free (Watch->Dir);
+    Watch->Dir = NULL;
+    Watch->DirAllocated = 0;
+    free (Watch->ByWd);
+    Watch->ByWd = NULL;
+    Watch->ByWdSize = 0;
+    HashMapFree (&Watch->Items);
+  }
+
+#endif // _Windows
+
+
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Duplicate Files: find sets of identical regular files in a list read by ReadDir
+//   Files are grouped by Size, then by a hash of their first block, then by a
+//   hash of the whole file. Hashing runs on Threads threads (<= 0: one per
+//   processor), which also bounds how many files are read at once.
+//   Matches are by 64 bit hash: compare contents before deleting anything.
+//   Hard links to one file (or an item listed twice) count once: they waste nothing.
+//   Each set is a _DirEntry (Size: bytes wasted, Count: copies) so sets can be
+//   sorted with SortDir ((_DirEntry **) &Sets, sSize).
+
+#define DupPrefixSize 4096
+#define DupChunkSize 0x100000
+
+typedef struct DupFile
+  {
+    struct DupFile *Next;
+    _DirEntry *Item;
+    unsigned long long Hash;
+    longint Dev, Ino;   // From the first block's pass. Ino 0: not known
+    bool Error;
+  } _DupFile;
+
+typedef struct
+  {
+    _DirEntry Entry;   // Must be first
+    _DirEntry **File;   // Items in the list given to FindDuplicates
+    int Files;
+    unsigned long long Hash;
+  } _DupSet;
+
+typedef struct
+  {
+    _DupFile **File;
+    int Size;
+    int Next;   // Next File to hash. Shared by the threads
+    bool Full;   // Whole file, not just the first block
+  } _DupJobs;
+
+int DupFileCompare (_DupFile *A, _DupFile *B)
+  {
+    if (A->Item->Size != B->Item->Size)
+      return A->Item->Size < B->Item->Size ? -1 : +1;
+    if (A->Hash != B->Hash)
+      return A->Hash < B->Hash ? -1 : +1;
+    return 0;
+  }
+
+int DupFileSortCompare (_DupFile *A, _DupFile *B)   // Also brings links to the same file together
+  {
+    int Res;
+    //
+    Res = DupFileCompare (A, B);
+    if (Res == 0 && A->Dev != B->Dev)
+      Res = A->Dev < B->Dev ? -1 : +1;
+    if (Res == 0 && A->Ino != B->Ino)
+      Res = A->Ino < B->Ino ? -1 : +1;
+    return Res;
+  }
+
+bool DupSameFile (_DupFile *A, _DupFile *B)
+  {
+    return (bool) (A->Ino != 0 && A->Ino == B->Ino && A->Dev == B->Dev);
+  }
+
+void DupHashFile (_DupFile *File, bool Full, byte *Buffer)
+  {
+    struct stat st;
+    char *Path;
+    int f, n;
+    longint Left;
+    //
+    Path = GetItemPath (File->Item);
+    f = open (Path, O_RDONLY);
+    free (Path);
+    File->Error = true;
+    if (f < 0)
+      return;
+    if (!Full && fstat (f, &st) == 0)
+      {
+        File->Dev = st.st_dev;
+        File->Ino = st.st_ino;
+      }
+    #ifndef _Windows
+    if (Full)
+      posix_fadvise (f, 0, 0, POSIX_FADV_SEQUENTIAL);
+    #endif
+    File->Hash = 0;
+    Left = File->Item->Size;
+    if (!Full && Left > DupPrefixSize)
+      Left = DupPrefixSize;
+    while (Left > 0)
+      {
+        n = read (f, Buffer, Left < DupChunkSize ? Left : DupChunkSize);
+        if (n <= 0)
+          break;
+        File->Hash = HashData64 (Buffer, n, File->Hash);
+        Left -= n;
+      }
+    close (f);
+    File->Error = (bool) (Left != 0);   // changed size or unreadable
+  }
+
+void *DupHashThread (void *Data)
+  {
+    _DupJobs *Jobs;
+    byte *Buffer;
+    int i;
+    //
+    Jobs = (_DupJobs *) Data;
+    Buffer = (byte *) malloc (Jobs->Full ? DupChunkSize : DupPrefixSize);
+    if (Buffer)
+      {
+        while ((i = __atomic_fetch_add (&Jobs->Next, 1, __ATOMIC_RELAXED)) < Jobs->Size)
+          DupHashFile (Jobs->File [i], Jobs->Full, Buffer);
+        free (Buffer);
+      }
+    return NULL;
+  }
+
+// Hash Files (that need it) in parallel
+void DupHash (_DupFile *Files, bool Full, int Threads)
+  {
+    _DupJobs Jobs;
+    _DupFile *f;
+    int i;
+    #ifndef _Windows
+    pthread_t Thread [SortListThreadsMax];
+    bool Started [SortListThreadsMax];
+    #endif
+    //
+    MemSet (&Jobs, 0, sizeof (Jobs));
+    Jobs.Full = Full;
+    for (f = Files; f; f = f->Next)
+      if (!Full || f->Item->Size > DupPrefixSize)
+        Jobs.Size++;
+    if (Jobs.Size == 0)
+      return;
+    Jobs.File = (_DupFile **) malloc (sizeof (_DupFile *) * Jobs.Size);
+    if (Jobs.File == NULL)
+      return;
+    i = 0;
+    for (f = Files; f; f = f->Next)
+      if (!Full || f->Item->Size > DupPrefixSize)
+        Jobs.File [i++] = f;
+    #ifdef _Windows
+    DupHashThread (&Jobs);
+    #else
+    if (Threads <= 0)
+      Threads = sysconf (_SC_NPROCESSORS_ONLN);
+    if (Threads < 1)   // sysconf failed (-1)
+      Threads = 1;
+    if (Threads > SortListThreadsMax)
+      Threads = SortListThreadsMax;
+    if (Threads > Jobs.Size)
+      Threads = Jobs.Size;
+    for (i = 1; i < Threads; i++)
+      Started [i] = (bool) (pthread_create (&Thread [i], NULL, DupHashThread, &Jobs) == 0);
+    DupHashThread (&Jobs);   // This thread helps too
+    for (i = 1; i < Threads; i++)
+      if (Started [i])
+        pthread_join (Thread [i], NULL);
+    #endif
+    free (Jobs.File);
+  }
+
+// Sort Files by Size & Hash, keep one of each file's links and free those not in
+// a group of 2 or more different files
+_DupFile *DupGroup (_DupFile *Files)
+  {
+    _DupFile *Res, **Tail, *a, *b, *f, *Prev;
+    int n;
+    //
+    Files = (_DupFile *) SortList ((void **) Files, (_SortListCompare *) &DupFileSortCompare);
+    Res = NULL;
+    Tail = &Res;
+    a = Files;
+    while (a)
+      {
+        n = 0;   // Different files that could be read
+        Prev = NULL;
+        for (b = a; b && DupFileCompare (a, b) == 0; b = b->Next)
+          if (!b->Error)
+            {
+              if (Prev == NULL || !DupSameFile (Prev, b))
+                n++;
+              Prev = b;
+            }
+        Prev = NULL;
+        while (a != b)
+          {
+            f = a;
+            a = a->Next;
+            if (Prev && DupSameFile (Prev, f))   // Another link to the one kept
+              free (f);
+            else if (n > 1 && !f->Error)
+              {
+                *Tail = f;
+                Tail = &f->Next;
+                Prev = f;
+              }
+            else
+              free (f);
+          }
+      }
+    *Tail = NULL;
+    return Res;
+  }
+
+_DupSet *FindDuplicates (_DirEntry *List, longint MinSize, int Threads)
+  {
+    _DupFile *Files, *f, *g;
+    _DupSet *Res, *Set, **Tail;
+    int i;
+    //
+    // Regular files of interest
+    Files = NULL;
+    for (; List; List = List->Next)
+      if (S_ISREG (List->Attrib) && List->Size > 0 && List->Size >= MinSize)
+        {
+          f = (_DupFile *) malloc (sizeof (_DupFile));
+          if (f == NULL)
+            {
+              while (Files)
+                {
+                  f = Files;
+                  Files = Files->Next;
+                  free (f);
+                }
+              return NULL;
+            }
+          f->Item = List;
+          f->Hash = 0;
+          f->Dev = f->Ino = 0;
+          f->Error = false;
+          f->Next = Files;
+          Files = f;
+        }
+    // Same size -> same first block -> same content
+    Files = DupGroup (Files);
+    DupHash (Files, false, Threads);
+    Files = DupGroup (Files);
+    DupHash (Files, true, Threads);
+    Files = DupGroup (Files);
+    // Make the sets
+    Res = NULL;
+    Tail = &Res;
+    while (Files)
+      {
+        Set = (_DupSet *) malloc (sizeof (_DupSet));
+        MemSet (Set, 0, sizeof (_DupSet));
+        Set->Hash = Files->Hash;
+        for (g = Files; g && DupFileCompare (Files, g) == 0; g = g->Next)
+          Set->Files++;
+        Set->File = (_DirEntry **) malloc (sizeof (_DirEntry *) * Set->Files);
+        for (i = 0; i < Set->Files; i++)
+          {
+            f = Files;
+            Files = Files->Next;
+            Set->File [i] = f->Item;
+            free (f);
+          }
+        StrAssign (&Set->Entry.Path, Set->File [0]->Path);
+        StrAssign (&Set->Entry.Name, Set->File [0]->Name);
+        Set->Entry.Attrib = Set->File [0]->Attrib;
+        Set->Entry.DateTime = Set->File [0]->DateTime;
+        Set->Entry.Count = Set->Files;
+        Set->Entry.Size = Set->File [0]->Size * (Set->Files - 1);   // Wasted
+        *Tail = Set;
+        Tail = (_DupSet **) &Set->Entry.Next;
+      }
+    return Res;
+  }
+
+void FreeDuplicates (_DupSet *Sets)
+  {
+    _DupSet *Next;
+    //
+    while (Sets)
+      {
+        Next = (_DupSet *) Sets->Entry.Next;
+        FreeDirItemContents (&Sets->Entry);
+        free (Sets->File);
+        free (Sets);
+        Sets = Next;
+      }
+  }
+
+
+//////////////////////////////////////////////////////////////////////////////////
+//
+// Disk Usage Tree
+//   A tree of nodes (parent, children & siblings) each with the totals of itself
+//   and everything below it: item Count, apparent Size and allocated Blocks (bytes).
+//   A file with several hard links is counted once, by the first link found. If
+//   that link goes, the next takes over.
+//   DuRescan () re-reads one node's subtree and corrects only its ancestors.
+
+#ifndef _Windows
+
+typedef struct DuNode
+  {
+    struct DuNode *Next;   // Sibling. First so a child list can be sorted with SortList
+    struct DuNode *Parent;
+    struct DuNode *Child;
+    struct DuNode *NextLink;   // Other nodes of the same inode
+    char *Name;   // The root holds its full path
+    bool Directory;
+    bool Counted;   // false if another hard link is counted instead
+    bool Error;   // Directory couldn't be read
+    int Links;
+    longint Dev, Ino;
+    longint Size;   // Apparent size
+    longint Blocks;   // Allocated bytes
+    longint TotalCount;   // This and everything below
+    longint TotalSize;
+    longint TotalBlocks;
+  } _DuNode;
+
+typedef struct
+  {
+    longint Dev, Ino;   // Ino 0: empty slot
+    _DuNode *Node;   // Counted node, first of its NextLink chain
+  } _DuLink;
+
+typedef struct
+  {
+    _DuNode *Root;
+    _DuLink *Link;   // Hard links: open addressing on Dev & Ino
+    int LinkSize;   // Power of 2
+    int LinkCount;
+    bool OneFileSystem;   // Don't cross into other devices
+  } _DuTree;
+
+_DuLink *DuLinkFind (_DuTree *Tree, longint Dev, longint Ino)   // Find or add
+  {
+    _DuLink *Old, *l;
+    longint Key [2];
+    int i, OldSize;
+    //
+    if ((Tree->LinkCount + 1) * 2 > Tree->LinkSize)   // Grow
+      {
+        Old = Tree->Link;
+        OldSize = Tree->LinkSize;
+        Tree->LinkSize = OldSize ? OldSize * 2 : 64;
+        Tree->Link = (_DuLink *) malloc (sizeof (_DuLink) * Tree->LinkSize);
+        MemSet (Tree->Link, 0, sizeof (_DuLink) * Tree->LinkSize);
+        Tree->LinkCount = 0;
+        for (i = 0; i < OldSize; i++)
+          if (Old [i].Ino)
+            DuLinkFind (Tree, Old [i].Dev, Old [i].Ino)->Node = Old [i].Node;
+        free (Old);
+      }
+    Key [0] = Dev;
+    Key [1] = Ino;
+    i = HashData64 (Key, sizeof (Key), 0) & (Tree->LinkSize - 1);
+    while (true)
+      {
+        l = &Tree->Link [i];
+        if (l->Ino == 0)   // New
+          {
+            l->Dev = Dev;
+            l->Ino = Ino;
+            l->Node = NULL;
+            Tree->LinkCount++;
+            return l;
+          }
+        if (l->Dev == Dev && l->Ino == Ino)
+          return l;
+        i = (i + 1) & (Tree->LinkSize - 1);
+      }
+  }
+
+// Adjust the totals of Node and all above it
+void DuAdjust (_DuNode *Node, longint Count, longint Size, longint Blocks)
+  {
+    while (Node)
+      {
+        Node->TotalCount += Count;
+        Node->TotalSize += Size;
+        Node->TotalBlocks += Blocks;
+        Node = Node->Parent;
+      }
+  }
+
+void DuLinkAdd (_DuTree *Tree, _DuNode *Node)
+  {
+    _DuLink *l;
+    //
+    l = DuLinkFind (Tree, Node->Dev, Node->Ino);
+    if (l->Node == NULL)   // First one is counted
+      {
+        l->Node = Node;
+        Node->NextLink = NULL;
+        Node->Counted = true;
+      }
+    else
+      {
+        Node->NextLink = l->Node->NextLink;
+        l->Node->NextLink = Node;
+        Node->Counted = false;
+      }
+  }
+
+void DuLinkRemove (_DuTree *Tree, _DuNode *Node)
+  {
+    _DuLink *l;
+    _DuNode **n;
+    //
+    l = DuLinkFind (Tree, Node->Dev, Node->Ino);
+    if (l->Node == Node)   // Next link is counted now
+      {
+        l->Node = Node->NextLink;
+        if (l->Node)
+          {
+            l->Node->Counted = true;
+            DuAdjust (l->Node, 0, l->Node->Size, l->Node->Blocks);
+          }
+      }
+    else
+      for (n = &l->Node; *n; n = &(*n)->NextLink)
+        if (*n == Node)
+          {
+            *n = Node->NextLink;
+            break;
+          }
+    Node->NextLink = NULL;
+    Node->Counted = false;
+  }
+
+void DuNodeSet (_DuTree *Tree, _DuNode *Node, struct stat *st)   // Own values from st
+  {
+    Node->Directory = S_ISDIR (st->st_mode) != 0;
+    Node->Links = st->st_nlink;
+    Node->Dev = st->st_dev;
+    Node->Ino = st->st_ino;
+    Node->Size = st->st_size;
+    Node->Blocks = (longint) st->st_blocks * 512;
+    Node->Counted = true;
+    if (!Node->Directory && Node->Links > 1)
+      DuLinkAdd (Tree, Node);
+    Node->TotalCount = 1;
+    Node->TotalSize = Node->Counted ? Node->Size : 0;
+    Node->TotalBlocks = Node->Counted ? Node->Blocks : 0;
+  }
+
+void DuNodeFree (_DuTree *Tree, _DuNode *Node)
+  {
+    _DuNode *c, *Next;
+    //
+    for (c = Node->Child; c; c = c->Next)   // Detach first: a link taking over below here
+      c->Parent = NULL;                    // must not change totals above
+    for (c = Node->Child; c; c = Next)
+      {
+        Next = c->Next;
+        DuNodeFree (Tree, c);
+      }
+    if (!Node->Directory && Node->Links > 1)
+      DuLinkRemove (Tree, Node);
+    free (Node->Name);
+    PoolFree (Node, sizeof (_DuNode));
+  }
+
+// Read the children of Node from DirFd (closed here)
+void DuReadAt (_DuTree *Tree, _DuNode *Node, int DirFd)
+  {
+    struct dirent *de;
+    struct stat st;
+    DIR *Dir;
+    _DuNode *n;
+    int SubFd;
+    //
+    Dir = fdopendir (DirFd);
+    if (Dir == NULL)
+      {
+        close (DirFd);
+        Node->Error = true;
+        return;
+      }
+    while ((de = readdir (Dir)))
+      if (StrCompare (de->d_name, ".") && StrCompare (de->d_name, ".."))
+        if (fstatat (dirfd (Dir), de->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0)
+          {
+            n = (_DuNode *) PoolAlloc (sizeof (_DuNode));
+            MemSet (n, 0, sizeof (_DuNode));
+            StrAssign (&n->Name, de->d_name);
+            DuNodeSet (Tree, n, &st);
+            n->Parent = Node;
+            n->Next = Node->Child;
+            Node->Child = n;
+            if (n->Directory && (!Tree->OneFileSystem || n->Dev == Tree->Root->Dev))
+              {
+                SubFd = openat (dirfd (Dir), de->d_name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+                if (SubFd >= 0)
+                  DuReadAt (Tree, n, SubFd);
+                else
+                  n->Error = true;
+              }
+            Node->TotalCount += n->TotalCount;
+            Node->TotalSize += n->TotalSize;
+            Node->TotalBlocks += n->TotalBlocks;
+          }
+    closedir (Dir);
+  }
+
+char *DuNodePath (_DuNode *Node)   // Caller must free Result
+  {
+    _DuNode *n;
+    char *Res, *p;
+    int Length, l;
+    //
+    Length = 0;
+    for (n = Node; n; n = n->Parent)
+      Length += StrLength (n->Name) + 1;
+    Res = (char *) malloc (Length + 1);
+    p = Res + Length;
+    *p = 0;
+    for (n = Node; n; n = n->Parent)
+      {
+        l = StrLength (n->Name);
+        p -= l;
+        MemMove (p, n->Name, l);
+        if (n->Parent && n->Parent->Name [0] && *(StrEnd (n->Parent->Name) - 1) != PathDelimiter)
+          *--p = PathDelimiter;
+      }
+    MemMove (Res, p, StrLength (p) + 1);
+    return Res;
+  }
+
+bool DuRead (_DuTree *Tree, char *Path, bool OneFileSystem)
+  {
+    struct stat st;
+    int DirFd;
+    //
+    MemSet (Tree, 0, sizeof (_DuTree));
+    Tree->OneFileSystem = OneFileSystem;
+    if (lstat (Path, &st) != 0)
+      return false;
+    Tree->Root = (_DuNode *) PoolAlloc (sizeof (_DuNode));
+    MemSet (Tree->Root, 0, sizeof (_DuNode));
+    Tree->Root->Name = realpath (Path, NULL);
+    DuNodeSet (Tree, Tree->Root, &st);
+    if (Tree->Root->Directory)
+      {
+        DirFd = open (Path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (DirFd >= 0)
+          DuReadAt (Tree, Tree->Root, DirFd);
+        else
+          Tree->Root->Error = true;
+      }
+    return true;
+  }
+
+// Remove Node and all below it from the tree
+void DuRemove (_DuTree *Tree, _DuNode *Node)
+  {
+    _DuNode **n;
+    //
+    if (Node->Parent == NULL)   // the root stays
+      return;
+    DuAdjust (Node->Parent, -Node->TotalCount, -Node->TotalSize, -Node->TotalBlocks);
+    for (n = &Node->Parent->Child; *n; n = &(*n)->Next)
+      if (*n == Node)
+        {
+          *n = Node->Next;
+          break;
+        }
+    Node->Parent = NULL;
+    DuNodeFree (Tree, Node);
+  }
+
+// Re-read Node (and all below it) after a change. Returns false if it has gone
+bool DuRescan (_DuTree *Tree, _DuNode *Node)
+  {
+    struct stat st;
+    _DuNode *c, *Next;
+    char *Path;
+    int DirFd;
+    //
+    Path = DuNodePath (Node);
+    if (lstat (Path, &st) != 0)
+      {
+        free (Path);
+        DuRemove (Tree, Node);
+        return false;
+      }
+    // Take the old totals out of the ancestors, then clear Node
+    DuAdjust (Node->Parent, -Node->TotalCount, -Node->TotalSize, -Node->TotalBlocks);
+    for (c = Node->Child; c; c = c->Next)
+      c->Parent = NULL;
+    for (c = Node->Child; c; c = Next)
+      {
+        Next = c->Next;
+        DuNodeFree (Tree, c);
+      }
+    Node->Child = NULL;
+    Node->Error = false;
+    if (!Node->Directory && Node->Links > 1)
+      DuLinkRemove (Tree, Node);
+    // Read it again and put the new totals in
+    DuNodeSet (Tree, Node, &st);
+    if (Node->Directory)
+      {
+        DirFd = open (Path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (DirFd >= 0)
+          DuReadAt (Tree, Node, DirFd);
+        else
+          Node->Error = true;
+      }
+    DuAdjust (Node->Parent, Node->TotalCount, Node->TotalSize, Node->TotalBlocks);
+    free (Path);
+    return true;
+  }
+
+int DuCompareBlocks (_DuNode *A, _DuNode *B)   // Biggest first
+  {
+    if (A->TotalBlocks != B->TotalBlocks)
+      return A->TotalBlocks > B->TotalBlocks ? -1 : +1;
+    return StrCompareCase (A->Name, B->Name, false);
+  }
+
+void DuSortChildren (_DuNode *Node, _SortListCompare *Compare)
+  {
+    Node->Child = (_DuNode *) SortList ((void **) Node->Child, Compare);
+  }
+
+void DuFree (_DuTree *Tree)
+  {
+    if (Tree->Root)
+      DuNodeFree (Tree, Tree->Root);
+    free (Tree->Link);
+    MemSet (Tree, 0, sizeof (_DuTree));
+  }
+
+#endif // _Windows
+
 
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
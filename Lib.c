@@ -33,6 +33,7 @@
 #else
   #include <unistd.h>
   #include <sys/time.h>
+  #include <pthread.h>   // Pools and parallel sorts: link with -pthread
   const char PathDelimiter = '/';
 #endif
 
@@ -127,21 +128,65 @@ void SwapByte (byte *a, byte *b)
     *b = c;
   }
 
-int LogN (int Val, int N)   // How many digits are needed?
+const unsigned long long Power10Table [20] =
+  {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+    10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+    1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+  };
+
+int BitLength (unsigned long long n)   // 0 for 0
   {
+    #ifdef __GNUC__
+    return n ? 64 - __builtin_clzll (n) : 0;
+    #else
     int Res;
     //
-    if (Val < 0)
-      return 0;
+    Res = 0;
+    while (n)
+      {
+        n >>= 1;
+        Res++;
+      }
+    return Res;
+    #endif
+  }
+
+int DigitCount (unsigned long long n, int Base)   // How many digits are needed? At least 1
+  {
+    int Res;
+    //
+    if (n == 0)
+      return 1;
+    switch (Base)
+      {
+        case 10:
+          Res = (BitLength (n) * 1233) >> 12;   // * log10 (2), may be one under
+          return Res + (n >= Power10Table [Res]);
+        case 2:
+        case 4:
+        case 8:
+        case 16:
+        case 32:
+          Res = BitLength (Base) - 1;   // Bits per digit
+          return (BitLength (n) + Res - 1) / Res;
+      }
     Res = 1;
-    while (Val >= N)
+    while (n >= (unsigned long long) Base)
       {
-        Val = Val / N;
+        n /= Base;
         Res++;
       }
     return Res;
   }
 
+int LogN (int Val, int N)   // How many digits are needed?
+  {
+    if (Val < 0)
+      return 0;
+    return DigitCount (Val, N);
+  }
+
 int ClockMS (void)
   {
 #ifdef _Windows
@@ -228,14 +273,29 @@ bool IsPrintable (char c)
 
 #define NotFound ((unsigned int) -1)
 
+const signed char DigitValue [256] =   // 0-9, A-Z and a-z as 0..35, otherwise -1
+  {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+    25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
+    -1, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24,
+    25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+  };
+
 int GetDigit (char c)   // converts to digit values 0-9,A-Z. Returns -1 if invalid
   {
-    c = UpCase (c);
-    if ((c >= '0') && (c <= '9'))
-      return c - '0';
-    if ((c >= 'A') && (c <= 'Z'))
-      return c - 'A' + 10;
-    return NotFound;
+    return DigitValue [(byte) c];
   }
 
 unsigned int StrPosCh (char *St, char Target);
@@ -270,8 +330,114 @@ int IsQuote (char c)
     return 0;
   }
 
+////////////////////////////////////////////////////////////////////////////
+//
+// Chunk at a time string primitives
+//   16 bytes with SSE2 (x86), 8 bytes as a 64 bit word (SWAR) elsewhere.
+//   Loads are aligned, or checked not to cross a page, so reading past the 0 is safe.
+//   Masks have one bit per byte that matched. Define LibScalar for the byte loops.
+
+#if defined (__GNUC__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && !defined (LibScalar)
+  #define LibFast
+  #include <stdint.h>
+  #define LibNoSanitize __attribute__ ((no_sanitize_address))
+  #define LibPageSafe(p) (((uintptr_t) (p) & 4095) <= 4096 - LibChunkSize)
+  #ifdef __SSE2__
+    #include <emmintrin.h>
+    #define LibChunkSize 16
+    typedef __m128i _LibChunk;
+    typedef unsigned int _LibMask;
+    #define LibLoad(p) _mm_load_si128 ((const __m128i *) (p))
+    #define LibLoadU(p) _mm_loadu_si128 ((const __m128i *) (p))
+    #define LibStoreU(p, c) _mm_storeu_si128 ((__m128i *) (p), c)
+    #define LibSplat(Ch) _mm_set1_epi8 (Ch)
+    #define LibMaskEq(a, b) ((_LibMask) _mm_movemask_epi8 (_mm_cmpeq_epi8 (a, b)))
+    #define LibMaskLess(c, n) ((_LibMask) _mm_movemask_epi8 (_mm_cmpeq_epi8 (_mm_min_epu8 (c, LibSplat ((n) - 1)), c)))   // Unsigned
+    #define LibMaskAll 0xFFFFu
+    #define LibMaskIndex(m) __builtin_ctz (m)
+    #define LibMaskCount(m) __builtin_popcount (m)
+    #define LibMaskFrom(n) ((LibMaskAll << (n)) & LibMaskAll)   // Bytes n and after
+    #define LibMaskBelow(n) ((1u << (n)) - 1)   // Bytes before n
+    #define LibShiftNext(c, Next) _mm_or_si128 (_mm_srli_si128 (c, 1), _mm_slli_si128 (Next, 15))   // Each byte's successor
+
+    _LibChunk LibUpCase (_LibChunk c)
+      {
+        _LibChunk Lower;
+        //
+        Lower = _mm_and_si128 (_mm_cmpgt_epi8 (c, _mm_set1_epi8 ('a' - 1)), _mm_cmplt_epi8 (c, _mm_set1_epi8 ('z' + 1)));
+        return _mm_sub_epi8 (c, _mm_and_si128 (Lower, _mm_set1_epi8 (0x20)));
+      }
+  #else
+    #define LibChunkSize 8
+    typedef unsigned long long _LibChunk;
+    typedef unsigned long long _LibMask;   // High bit of each byte
+    typedef unsigned long long __attribute__ ((may_alias, aligned (1))) _LibChunkU;
+    #define LibLoad(p) (*(const _LibChunkU *) (p))
+    #define LibLoadU(p) (*(const _LibChunkU *) (p))
+    #define LibStoreU(p, c) (*(_LibChunkU *) (p) = (c))
+    #define LibSplat(Ch) ((byte) (Ch) * 0x0101010101010101ULL)
+    #define LibLow7 0x7F7F7F7F7F7F7F7FULL
+    #define LibMaskAll 0x8080808080808080ULL
+    #define LibMaskIndex(m) (__builtin_ctzll (m) >> 3)
+    #define LibMaskCount(m) __builtin_popcountll (m)
+    #define LibMaskFrom(n) ((LibMaskAll << (8 * (n))) & LibMaskAll)
+    #define LibMaskBelow(n) ((n) >= 8 ? LibMaskAll : ((1ULL << (8 * (n))) - 1) & LibMaskAll)
+    #define LibShiftNext(c, Next) (((c) >> 8) | ((Next) << 56))
+
+    _LibMask LibMaskEq (_LibChunk a, _LibChunk b)   // Exact, no carries between bytes
+      {
+        _LibChunk x;
+        //
+        x = a ^ b;
+        return ~(((x & LibLow7) + LibLow7) | x | LibLow7);
+      }
+
+    _LibMask LibMaskLess (_LibChunk c, byte n)   // Bytes below n (1 .. 128), exact
+      {
+        return ~(((c & LibLow7) + LibSplat (0x80 - n)) | c) & LibMaskAll;
+      }
+
+    _LibChunk LibUpCase (_LibChunk c)
+      {
+        _LibChunk h, Lower;
+        //
+        h = c & LibLow7;
+        Lower = (h + LibSplat (0x80 - 'a')) & ~(h + LibSplat (0x80 - 'z' - 1)) & ~c & LibMaskAll;
+        return c ^ (Lower >> 2);
+      }
+  #endif
+
+// Address of the first Ch, or of the 0
+LibNoSanitize char *StrScan (const char *St, char Ch)
+  {
+    const char *p;
+    _LibChunk c, Zero, Target;
+    _LibMask m;
+    //
+    Zero = LibSplat (0);
+    Target = LibSplat (Ch);
+    p = (const char *) ((uintptr_t) St & ~(uintptr_t) (LibChunkSize - 1));
+    c = LibLoad (p);
+    m = (LibMaskEq (c, Zero) | LibMaskEq (c, Target)) & LibMaskFrom (St - p);
+    while (m == 0)
+      {
+        p += LibChunkSize;
+        c = LibLoad (p);
+        m = LibMaskEq (c, Zero) | LibMaskEq (c, Target);
+      }
+    return (char *) p + LibMaskIndex (m);
+  }
+#else
+  #define LibNoSanitize
+#endif // LibFast
+
 int StrLength (const char *St)
   {
+    #ifdef LibFast
+    if (St)
+      return StrScan (St, 0) - St;
+    return 0;
+    #else
     int Res;
     //
     Res = 0;
@@ -279,12 +445,25 @@ int StrLength (const char *St)
       while (*St++)
         Res++;
     return Res;
+    #endif
   }
 
 // StrCopy: Copies 0 terminated string. Returns address of the 0.
 //
+void MemMove (void *Dest, void *Source, unsigned int Size);
+
 char *StrCopy (char *Dest, const char *Source)
   {
+    #ifdef LibFast
+    int Length;
+    //
+    if (Dest && Source)
+      {
+        Length = StrScan (Source, 0) - Source;
+        MemMove (Dest, (void *) Source, Length + 1);
+        Dest += Length;
+      }
+    #else
     char c;
     //
     if (Dest && Source)
@@ -296,6 +475,7 @@ char *StrCopy (char *Dest, const char *Source)
             break;
           Dest++;
         }
+    #endif
     return Dest;
   }
 
@@ -340,16 +520,48 @@ void StrSwap (char *S1, char *S2)
 
 void MemMove (void *Dest, void *Source, unsigned int Size)
   {
+    #ifdef LibFast
+    // Each chunk is loaded before it is stored, so overlaps work as with bytes
+    if (Dest < Source)
+      {
+        for (; Size >= LibChunkSize; Size -= LibChunkSize)
+          {
+            LibStoreU (Dest, LibLoadU (Source));
+            Dest = (byte *) Dest + LibChunkSize;
+            Source = (byte *) Source + LibChunkSize;
+          }
+        while (Size--)
+          *(byte *) Dest++ = * (byte *) Source++;
+      }
+    else
+      {
+        for (; Size >= LibChunkSize; Size -= LibChunkSize)
+          LibStoreU ((byte *) Dest + Size - LibChunkSize, LibLoadU ((byte *) Source + Size - LibChunkSize));
+        while (Size--)
+          ((byte *) Dest) [Size] = ((byte *) Source) [Size];
+      }
+    #else
     if (Dest < Source)
       while (Size--)
         *(byte *) Dest++ = * (byte *) Source++;
     else
       while (Size--)
         ((byte *) Dest) [Size] = ((byte *) Source) [Size];
+    #endif
   }
 
 void MemSet (void *Dest, byte Value, unsigned int Size)
   {
+    #ifdef LibFast
+    _LibChunk c;
+    //
+    c = LibSplat (Value);
+    for (; Size >= LibChunkSize; Size -= LibChunkSize)
+      {
+        LibStoreU (Dest, c);
+        Dest = (byte *) Dest + LibChunkSize;
+      }
+    #endif
     while (Size--)
       *(byte *) Dest++ = Value;
   }
@@ -391,6 +603,457 @@ void StrAssignAppend (char **Dest, char *Suffix)   // Dynamic String Append
   }
 
 
+/////////////////////////////////////////////////////////////////////////////
+//
+// ARENAS
+//
+// _Arena: region allocator. Allocations are bumped out of large blocks and never freed
+//   one by one: ArenaRewind drops everything since an ArenaMark, ArenaFree the lot, in
+//   time that depends on the blocks, not the allocations. Good for the temporary strings
+//   of a frame or a scan. The Arena* string functions are the dynamic string ones with
+//   results in an arena; with a NULL arena they malloc as usual.
+//   Used, Peak and Total count bytes asked for (rounded to ArenaAlign).
+//   A big allocation gets a block of its own, linked behind the current block so the
+//   space left in that one is still used.
+
+#define ArenaAlign 16
+#define ArenaBlockSize 0x10000
+
+typedef struct _ArenaBlock
+  {
+    struct _ArenaBlock *Prev;
+    unsigned int Size;   // Bytes following this header
+    unsigned int Used;
+  } _ArenaBlock;
+
+typedef struct
+  {
+    _ArenaBlock *Block;   // Current, newest
+    _ArenaBlock *Spare;   // Kept by ArenaRewind for the next block
+    unsigned int BlockSize;
+    void *Last;   // Newest allocation, which ArenaRealloc can grow in place
+    longint Used;   // Bytes allocated now
+    longint Peak;   // Most Used has been
+    longint Total;   // Bytes ever allocated
+    longint Reserved;   // Bytes of blocks held
+  } _Arena;
+
+typedef struct
+  {
+    _ArenaBlock *Block;
+    _ArenaBlock *Prev;   // Block->Prev at the mark: big blocks put behind Block since go too
+    unsigned int BlockUsed;
+    longint Used;
+  } _ArenaMark;
+
+#define ArenaHeader ((sizeof (_ArenaBlock) + ArenaAlign - 1) & ~(ArenaAlign - 1))
+#define ArenaData(Block) ((byte *) (Block) + ArenaHeader)
+
+void ArenaInit (_Arena *Arena, unsigned int BlockSize)   // BlockSize 0 for the default
+  {
+    MemSet (Arena, 0, sizeof (_Arena));
+    Arena->BlockSize = BlockSize ? BlockSize : ArenaBlockSize;
+  }
+
+void ArenaFreeBlock (_Arena *Arena, _ArenaBlock *Block)
+  {
+    Arena->Reserved -= ArenaHeader + Block->Size;
+    free (Block);
+  }
+
+void ArenaFree (_Arena *Arena)   // Releases all its memory. Statistics are kept
+  {
+    _ArenaBlock *b;
+    //
+    while (Arena->Block)
+      {
+        b = Arena->Block;
+        Arena->Block = b->Prev;
+        ArenaFreeBlock (Arena, b);
+      }
+    if (Arena->Spare)
+      ArenaFreeBlock (Arena, Arena->Spare);
+    Arena->Spare = NULL;
+    Arena->Last = NULL;
+    Arena->Used = 0;
+  }
+
+void *ArenaAlloc (_Arena *Arena, unsigned int Size)   // NULL if out of memory
+  {
+    _ArenaBlock *b;
+    unsigned int BlockSize;
+    void *Res;
+    //
+    Size = (Size + ArenaAlign - 1) & ~(ArenaAlign - 1);
+    b = Arena->Block;
+    if (b == NULL || b->Size - b->Used < Size)   // Another block
+      {
+        BlockSize = Size > Arena->BlockSize / 4 ? Size : Arena->BlockSize;   // Big ones get their own
+        b = Arena->Spare;
+        if (b && b->Size >= BlockSize)
+          Arena->Spare = NULL;
+        else
+          {
+            b = (_ArenaBlock *) malloc (ArenaHeader + BlockSize);
+            if (b == NULL)
+              return NULL;
+            b->Size = BlockSize;
+            Arena->Reserved += ArenaHeader + BlockSize;
+          }
+        b->Used = 0;
+        if (Arena->Block && BlockSize == Size)   // Big: behind the current one, which stays
+          {
+            b->Prev = Arena->Block->Prev;
+            Arena->Block->Prev = b;
+            b->Used = Size;
+            Arena->Last = NULL;   // Not in the current block
+            Res = ArenaData (b);
+            Arena->Used += Size;
+            Arena->Total += Size;
+            if (Arena->Peak < Arena->Used)
+              Arena->Peak = Arena->Used;
+            return Res;
+          }
+        b->Prev = Arena->Block;
+        Arena->Block = b;
+      }
+    Res = ArenaData (b) + b->Used;
+    b->Used += Size;
+    Arena->Last = Res;
+    Arena->Used += Size;
+    Arena->Total += Size;
+    if (Arena->Peak < Arena->Used)
+      Arena->Peak = Arena->Used;
+    return Res;
+  }
+
+// As realloc, given the Size of p. The newest allocation grows or shrinks where it is
+void *ArenaRealloc (_Arena *Arena, void *p, unsigned int Size, unsigned int NewSize)
+  {
+    _ArenaBlock *b;
+    void *Res;
+    //
+    b = Arena->Block;
+    Size = (Size + ArenaAlign - 1) & ~(ArenaAlign - 1);
+    NewSize = (NewSize + ArenaAlign - 1) & ~(ArenaAlign - 1);
+    if (p && p == Arena->Last && (byte *) p - ArenaData (b) + NewSize <= b->Size)
+      {
+        b->Used = (byte *) p - ArenaData (b) + NewSize;
+        Arena->Used += (longint) NewSize - Size;
+        if (NewSize > Size)
+          Arena->Total += NewSize - Size;
+        if (Arena->Peak < Arena->Used)
+          Arena->Peak = Arena->Used;
+        return p;
+      }
+    if (NewSize <= Size)
+      return p;
+    Res = ArenaAlloc (Arena, NewSize);
+    if (Res && p)
+      MemMove (Res, p, Size);
+    return Res;
+  }
+
+_ArenaMark ArenaMark (_Arena *Arena)
+  {
+    _ArenaMark Res;
+    //
+    Res.Block = Arena->Block;
+    Res.Prev = Arena->Block ? Arena->Block->Prev : NULL;
+    Res.BlockUsed = Arena->Block ? Arena->Block->Used : 0;
+    Res.Used = Arena->Used;
+    return Res;
+  }
+
+void ArenaDropBlock (_Arena *Arena, _ArenaBlock *Block)
+  {
+    if (Arena->Spare == NULL || Arena->Spare->Size < Block->Size)   // Keep the biggest to reuse
+      {
+        if (Arena->Spare)
+          ArenaFreeBlock (Arena, Arena->Spare);
+        Arena->Spare = Block;
+      }
+    else
+      ArenaFreeBlock (Arena, Block);
+  }
+
+void ArenaRewind (_Arena *Arena, _ArenaMark Mark)   // Everything allocated since Mark goes
+  {
+    _ArenaBlock *b;
+    //
+    while (Arena->Block != Mark.Block)
+      {
+        b = Arena->Block;
+        Arena->Block = b->Prev;
+        ArenaDropBlock (Arena, b);
+      }
+    if (Arena->Block)
+      {
+        while (Arena->Block->Prev != Mark.Prev)   // Big ones put behind it
+          {
+            b = Arena->Block->Prev;
+            Arena->Block->Prev = b->Prev;
+            ArenaDropBlock (Arena, b);
+          }
+        Arena->Block->Used = Mark.BlockUsed;
+      }
+    Arena->Last = NULL;
+    Arena->Used = Mark.Used;
+  }
+
+void ArenaReset (_Arena *Arena)   // Empty but keeping a block
+  {
+    _ArenaMark Mark;
+    //
+    MemSet (&Mark, 0, sizeof (Mark));
+    ArenaRewind (Arena, Mark);
+  }
+
+void *LibAlloc (_Arena *Arena, unsigned int Size)   // From Arena, or malloc if NULL
+  {
+    if (Arena)
+      return ArenaAlloc (Arena, Size);
+    return malloc (Size);
+  }
+
+void *LibRealloc (_Arena *Arena, void *p, unsigned int Size, unsigned int NewSize)
+  {
+    if (Arena)
+      return ArenaRealloc (Arena, p, Size, NewSize);
+    return realloc (p, NewSize);
+  }
+
+char *ArenaStr (_Arena *Arena, char *Source)   // Copy of Source, NULL for NULL
+  {
+    char *Res;
+    unsigned int Length;
+    //
+    if (Source == NULL)
+      return NULL;
+    Length = StrLength (Source) + 1;
+    Res = (char *) LibAlloc (Arena, Length);
+    if (Res)
+      MemMove (Res, Source, Length);
+    return Res;
+  }
+
+void ArenaStrAssign (_Arena *Arena, char **Dest, char *Source)   // StrAssign. The old *Dest stays with the arena
+  {
+    if (Arena == NULL)
+      StrAssign (Dest, Source);
+    else
+      *Dest = ArenaStr (Arena, Source);
+  }
+
+void ArenaStrAssignAppend (_Arena *Arena, char **Dest, char *Suffix)   // StrAssignAppend. In place if *Dest is the newest
+  {
+    unsigned int Length, LengthSuffix;
+    char *New;
+    //
+    if (Arena == NULL)
+      StrAssignAppend (Dest, Suffix);
+    else
+      {
+        Length = StrLength (*Dest);
+        LengthSuffix = StrLength (Suffix);
+        New = (char *) ArenaRealloc (Arena, *Dest, *Dest ? Length + 1 : 0, Length + LengthSuffix + 1);
+        if (New)
+          {
+            MemMove (New + Length, Suffix, LengthSuffix);
+            New [Length + LengthSuffix] = 0;
+            *Dest = New;
+          }
+      }
+  }
+
+
+/////////////////////////////////////////////////////////////////////////////
+//
+// POOLS
+//
+// PoolAlloc / PoolFree: small objects (up to PoolClasses * PoolClassSize bytes) in size
+//   classes. Each thread keeps its own free lists, so most calls take no lock; a thread
+//   refills from, and returns surplus to, a central list per class in batches of
+//   PoolBatch. Memory stays with the pools once carved out of a slab. The caller gives
+//   PoolFree the size it asked for; larger sizes simply go to malloc/free.
+
+#define PoolClassSize 16
+#define PoolClasses 16
+#define PoolBatch 32
+#define PoolSlab 0x10000
+
+#ifdef _Windows
+
+void *PoolAlloc (unsigned int Size)
+  {
+    return malloc (Size);
+  }
+
+void PoolFree (void *p, unsigned int Size)
+  {
+    free (p);
+  }
+
+#else
+
+typedef struct _PoolObject
+  {
+    struct _PoolObject *Next;
+    struct _PoolObject *NextBatch;   // In the first of a batch on a central list
+  } _PoolObject;
+
+typedef struct
+  {
+    pthread_mutex_t Lock;
+    _PoolObject *Batch;
+    byte *Slab;   // Not yet carved
+    unsigned int SlabLeft;
+  } _PoolCentral;
+
+typedef struct
+  {
+    _PoolObject *Free;
+    int Count;
+  } _PoolCache;
+
+_PoolCentral PoolCentral [PoolClasses];
+pthread_once_t PoolOnce = PTHREAD_ONCE_INIT;
+pthread_key_t PoolKey;
+__thread _PoolCache PoolCache [PoolClasses];
+__thread bool PoolThread;   // PoolKey set, to flush PoolCache at thread exit
+
+void PoolFlush (int Class, int Count)   // The first Count in the thread's cache back to the central list
+  {
+    _PoolCache *Cache;
+    _PoolCentral *Central;
+    _PoolObject *Batch, *Last;
+    int i;
+    //
+    Cache = &PoolCache [Class];
+    Batch = Last = Cache->Free;
+    for (i = 1; i < Count; i++)
+      Last = Last->Next;
+    Cache->Free = Last->Next;
+    Cache->Count -= Count;
+    Last->Next = NULL;
+    Central = &PoolCentral [Class];
+    pthread_mutex_lock (&Central->Lock);
+    Batch->NextBatch = Central->Batch;
+    Central->Batch = Batch;
+    pthread_mutex_unlock (&Central->Lock);
+  }
+
+void PoolThreadExit (void *Data)
+  {
+    int c;
+    //
+    (void) Data;
+    for (c = 0; c < PoolClasses; c++)
+      if (PoolCache [c].Count)
+        PoolFlush (c, PoolCache [c].Count);
+  }
+
+void PoolInit (void)
+  {
+    int c;
+    //
+    for (c = 0; c < PoolClasses; c++)
+      pthread_mutex_init (&PoolCentral [c].Lock, NULL);
+    pthread_key_create (&PoolKey, PoolThreadExit);
+  }
+
+void PoolThreadStart (void)
+  {
+    pthread_once (&PoolOnce, PoolInit);
+    pthread_setspecific (PoolKey, PoolCache);
+    PoolThread = true;
+  }
+
+bool PoolRefill (int Class)   // A batch into the thread's empty cache
+  {
+    _PoolCache *Cache;
+    _PoolCentral *Central;
+    _PoolObject *p;
+    unsigned int Size;
+    int i;
+    //
+    if (!PoolThread)
+      PoolThreadStart ();
+    Cache = &PoolCache [Class];
+    Central = &PoolCentral [Class];
+    Size = (Class + 1) * PoolClassSize;
+    pthread_mutex_lock (&Central->Lock);
+    if (Central->Batch)
+      {
+        Cache->Free = Central->Batch;
+        Central->Batch = Central->Batch->NextBatch;
+      }
+    else
+      {
+        if (Central->SlabLeft < Size * PoolBatch)   // The rest of the slab is lost
+          {
+            Central->Slab = (byte *) malloc (PoolSlab);
+            Central->SlabLeft = Central->Slab ? PoolSlab : 0;
+          }
+        for (i = 0; i < PoolBatch && Central->SlabLeft >= Size; i++)
+          {
+            p = (_PoolObject *) Central->Slab;
+            p->Next = Cache->Free;
+            Cache->Free = p;
+            Central->Slab += Size;
+            Central->SlabLeft -= Size;
+          }
+      }
+    pthread_mutex_unlock (&Central->Lock);
+    Cache->Count = 0;
+    for (p = Cache->Free; p; p = p->Next)
+      Cache->Count++;
+    return Cache->Free != NULL;
+  }
+
+void *PoolAlloc (unsigned int Size)   // NULL if out of memory
+  {
+    _PoolCache *Cache;
+    _PoolObject *p;
+    int Class;
+    //
+    if (Size > PoolClasses * PoolClassSize)
+      return malloc (Size);
+    Class = Size ? (Size - 1) / PoolClassSize : 0;
+    Cache = &PoolCache [Class];
+    if (Cache->Free == NULL && !PoolRefill (Class))
+      return NULL;
+    p = Cache->Free;
+    Cache->Free = p->Next;
+    Cache->Count--;
+    return p;
+  }
+
+void PoolFree (void *p, unsigned int Size)   // Size as given to PoolAlloc
+  {
+    _PoolCache *Cache;
+    int Class;
+    //
+    if (p == NULL)
+      return;
+    if (!PoolThread)
+      PoolThreadStart ();
+    if (Size > PoolClasses * PoolClassSize)
+      {
+        free (p);
+        return;
+      }
+    Class = Size ? (Size - 1) / PoolClassSize : 0;
+    Cache = &PoolCache [Class];
+    ((_PoolObject *) p)->Next = Cache->Free;
+    Cache->Free = (_PoolObject *) p;
+    if (++Cache->Count >= PoolBatch * 2)   // Let other threads have some
+      PoolFlush (Class, PoolBatch);
+  }
+
+#endif // _Windows
+
+
 /////////////////////////////////////////////////////////////////////////////
 //
 // Search String: StrPos, StrPosFrom, StrPosBackwards
@@ -465,19 +1128,218 @@ unsigned int StrMatch (char *St, char *Target, int TargetLen, _StrPosMode StrPos
       }
   }
 
-unsigned int StrPosFrom (char *St, unsigned int Start, char *Target, _StrPosMode StrPosMode)
+////////////////////////////////////////////////////////////////////////////
+//
+// Substring search
+//   spmStrict & spmNoCase: places where the first two characters match are found a chunk
+//   at a time, then checked with StrMatch.
+//   spmWild: the pattern is compiled into a _StrWild, which can be kept for many searches.
+
+// First place in St where a then b are (b 0: just a), or the 0
+#ifdef LibFast
+LibNoSanitize char *StrScanPair (char *St, char a, char b, bool Cased)
   {
-    if (Target == NULL || Target [0] == 0)
-      return Start;
-    if (St == NULL)
-      return -1;
+    char *p;
+    _LibChunk c, Next, Zero, A, B;
+    _LibMask m, z, Valid;
+    //
+    if (!Cased)
+      {
+        a = UpCase (a);
+        b = UpCase (b);
+      }
+    Zero = LibSplat (0);
+    A = LibSplat (a);
+    B = LibSplat (b);
+    p = (char *) ((uintptr_t) St & ~(uintptr_t) (LibChunkSize - 1));
+    Valid = LibMaskFrom (St - p);
+    c = LibLoad (p);
+    if (!Cased)
+      c = LibUpCase (c);
     while (true)
       {
-        if (StrMatch (&St [Start], Target, 0, StrPosMode))   // Found
-          return Start;
-        if (St [Start] == 0)   // Not found
-          return -1;
-        Start++;
+        z = LibMaskEq (c, Zero) & Valid;
+        if (z)   // Last chunk: the successors before the 0 are all in it
+          {
+            m = LibMaskEq (c, A) & Valid & ((z & -z) - 1);
+            if (b)
+              m &= LibMaskEq (LibShiftNext (c, Zero), B);
+            return p + LibMaskIndex (m ? m : z);
+          }
+        Next = LibLoad (p + LibChunkSize);   // No 0 so far, so St goes on into it
+        if (!Cased)
+          Next = LibUpCase (Next);
+        m = LibMaskEq (c, A) & Valid;
+        if (b)
+          m &= LibMaskEq (LibShiftNext (c, Next), B);
+        if (m)
+          return p + LibMaskIndex (m);
+        p += LibChunkSize;
+        c = Next;
+        Valid = LibMaskAll;
+      }
+  }
+#else
+char *StrScanPair (char *St, char a, char b, bool Cased)
+  {
+    if (!Cased)
+      {
+        a = UpCase (a);
+        b = UpCase (b);
+      }
+    for (; *St; St++)
+      if ((Cased ? St [0] : UpCase (St [0])) == a)
+        if (b == 0 || (Cased ? St [1] : UpCase (St [1])) == b)
+          break;
+    return St;
+  }
+#endif // LibFast
+
+// Compiled spmWild pattern: ? any, # digit, @ alpha, & non alpha, ~x not x, ^x control x
+
+#define StrWildMax 128
+
+typedef enum {swChar, swAny, swDigit, swAlpha, swNonAlpha, swNot, swControl} _StrWildKind;
+
+typedef struct
+  {
+    int Count;   // 0: matches nothing
+    byte Kind [StrWildMax];
+    char Ch [StrWildMax];   // swChar & swNot: upper case. swControl: the control character
+  } _StrWild;
+
+bool StrWildCompile (_StrWild *Wild, char *Pattern)   // false if too long
+  {
+    char t;
+    //
+    Wild->Count = 0;
+    while ((t = *Pattern++))
+      {
+        if (Wild->Count == StrWildMax)
+          return false;
+        Wild->Kind [Wild->Count] = swChar;
+        Wild->Ch [Wild->Count] = UpCase (t);
+        if (t == '?')
+          Wild->Kind [Wild->Count] = swAny;
+        else if (t == '#')
+          Wild->Kind [Wild->Count] = swDigit;
+        else if (t == '@')
+          Wild->Kind [Wild->Count] = swAlpha;
+        else if (t == '&')
+          Wild->Kind [Wild->Count] = swNonAlpha;
+        else if (t == '~' || t == '^')
+          {
+            if (*Pattern == 0)   // StrMatch never matches these
+              {
+                Wild->Count = 0;
+                return true;
+              }
+            Wild->Kind [Wild->Count] = t == '~' ? swNot : swControl;
+            t = *Pattern++;
+            Wild->Ch [Wild->Count] = Wild->Kind [Wild->Count] == swNot ? UpCase (t) : t & 0x1F;
+          }
+        Wild->Count++;
+      }
+    return true;
+  }
+
+unsigned int StrWildMatch (_StrWild *Wild, char *St)   // As StrMatch (St, Pattern, 0, spmWild)
+  {
+    int i;
+    char s;
+    //
+    for (i = 0; i < Wild->Count; i++)
+      {
+        s = St [i];
+        switch (Wild->Kind [i])
+          {
+            case swChar:
+              if (UpCase (s) != Wild->Ch [i])
+                return 0;
+              break;
+            case swAny:
+              break;
+            case swDigit:
+              if (!IsDigit (s))
+                return 0;
+              break;
+            case swAlpha:
+              if (!IsAlpha (s))
+                return 0;
+              break;
+            case swNonAlpha:
+              if (IsAlpha (s))
+                return 0;
+              break;
+            case swNot:
+              if (UpCase (s) == Wild->Ch [i])
+                return 0;
+              break;
+            case swControl:
+              if (s != Wild->Ch [i])
+                return 0;
+              break;
+          }
+        if (s == 0 && i + 1 < Wild->Count)   // Nothing to match after the end
+          return 0;
+      }
+    return Wild->Count;
+  }
+
+unsigned int StrWildPosFrom (_StrWild *Wild, char *St, unsigned int Start)   // returns array index. -1 if not found
+  {
+    char *p;
+    //
+    if (St == NULL || Wild->Count == 0)
+      return -1;
+    p = &St [Start];
+    while (true)
+      {
+        if (Wild->Kind [0] == swChar)   // Skip to where it could start
+          {
+            p = StrScanPair (p, Wild->Ch [0], Wild->Count > 1 && Wild->Kind [1] == swChar ? Wild->Ch [1] : 0, false);
+            if (*p == 0)
+              return -1;
+          }
+        if (StrWildMatch (Wild, p))   // Found
+          return p - St;
+        if (*p == 0)   // Not found
+          return -1;
+        p++;
+      }
+  }
+
+unsigned int StrPosFrom (char *St, unsigned int Start, char *Target, _StrPosMode StrPosMode)
+  {
+    _StrWild Wild;
+    char *p;
+    //
+    if (Target == NULL || Target [0] == 0)
+      return Start;
+    if (St == NULL)
+      return -1;
+    if (StrPosMode != spmWild)
+      {
+        p = &St [Start];
+        while (true)
+          {
+            p = StrScanPair (p, Target [0], Target [1], StrPosMode != spmNoCase);
+            if (*p == 0)   // Not found
+              return -1;
+            if (StrMatch (p, Target, 0, StrPosMode))   // Found
+              return p - St;
+            p++;
+          }
+      }
+    if (StrWildCompile (&Wild, Target))
+      return StrWildPosFrom (&Wild, St, Start);
+    while (true)
+      {
+        if (StrMatch (&St [Start], Target, 0, StrPosMode))   // Found
+          return Start;
+        if (St [Start] == 0)   // Not found
+          return -1;
+        Start++;
       }
   }
 
@@ -509,6 +1371,16 @@ unsigned int StrPos_ (char *St, char *Target)
 
 unsigned int StrPosChFrom (char *St, unsigned int Start, char Target)   // returns array index. "-1" if not found
   {
+    #ifdef LibFast
+    char *p;
+    //
+    if (St)
+      {
+        p = StrScan (&St [Start], Target);
+        if (*p)
+          return p - St;
+      }
+    #else
     if (St)
       while (St [Start])
         {
@@ -516,6 +1388,7 @@ unsigned int StrPosChFrom (char *St, unsigned int Start, char Target)   // retur
             return Start;
           Start++;
         }
+    #endif
     return -1;
   }
 
@@ -526,6 +1399,12 @@ unsigned int StrPosCh (char *St, char Target)   // returns array index. "-1" if
 
 char *StrPosCh_ (char *St, char Target)   // returns pointer to Target or NULL
   {
+    #ifdef LibFast
+    St = StrScan (St, Target);
+    if (*St == 0)
+      return NULL;
+    return St;
+    #else
     while (true)
       {
         if (*St == 0)
@@ -534,6 +1413,7 @@ char *StrPosCh_ (char *St, char Target)   // returns pointer to Target or NULL
           return St;
         St++;
       }
+    #endif
   }
 
 unsigned int StrPosLastCh (char *St, char Target)
@@ -553,11 +1433,44 @@ unsigned int StrPosLastCh (char *St, char Target)
     return Res;
   }
 
-unsigned int StrChCount (char *St, char Target, unsigned int Size)
+LibNoSanitize unsigned int StrChCount (char *St, char Target, unsigned int Size)   // Size 0: to the end of St
   {
     unsigned int Res;
+    #ifdef LibFast
+    char *p;
+    _LibChunk c, Zero, Chars;
+    _LibMask m, z, Valid;
+    unsigned int Off, n;
+    #endif
     //
     Res = 0;
+    #ifdef LibFast
+    Zero = LibSplat (0);
+    Chars = LibSplat (Target);
+    p = (char *) ((uintptr_t) St & ~(uintptr_t) (LibChunkSize - 1));
+    Off = St - p;
+    while (true)
+      {
+        c = LibLoad (p);
+        Valid = LibMaskFrom (Off);
+        n = LibChunkSize - Off;   // Bytes of St in this chunk
+        if (Size && Size <= n)
+          Valid &= LibMaskBelow (Off + Size);
+        z = LibMaskEq (c, Zero) & Valid;
+        m = LibMaskEq (c, Chars) & Valid;
+        if (z)   // Only those before the 0
+          return Res + LibMaskCount (m & ((z & -z) - 1));
+        Res += LibMaskCount (m);
+        if (Size)
+          {
+            if (Size <= n)
+              break;
+            Size -= n;
+          }
+        p += LibChunkSize;
+        Off = 0;
+      }
+    #else
     while (true)
       {
         if (*St == 0)
@@ -569,42 +1482,237 @@ unsigned int StrChCount (char *St, char Target, unsigned int Size)
             break;
         St++;
       }
+    #endif
     return Res;
   }
 
-// StrPosMulti: Targets: multiple, space separated
-bool StrPosMulti (char *St, char *Targets, _StrPosMode StrPosMode)
+/////////////////////////////////////////////////////////////////////////////
+//
+// Multi Pattern Search: Aho-Corasick
+//   Targets: multiple, space separated. Built once, then any number of strings searched,
+//   each in a single pass. Characters are mapped to classes (0: in no Target), so the
+//   transition table is States x Classes.
+//   spmWild: the Targets are compiled with StrWildCompile and tried at each place in turn.
+
+typedef struct
   {
-    int p1, p2, Res;
-    char c;
+    _StrPosMode Mode;
+    int Patterns;
+    char **Pattern;   // Into Targets
+    char *Targets;   // Copy, each one 0 terminated
+    byte Class [256];
+    int Classes;
+    int States;
+    int *Next;   // [State * Classes + Class]
+    int *Out;   // Pattern ending at this state. -1: none
+    int *OutLink;   // Next state down the suffixes with an Out. -1: none
+    _StrWild *Wild;
+  } _StrMulti;
+
+// Called for each match, return false to stop
+typedef bool _StrMultiCallback (int Pattern, unsigned int Pos, void *Data);
+
+void StrMultiBuild (_StrMulti *Multi, char *Targets, _StrPosMode StrPosMode)
+  {
+    int *Fail, *Queue;
+    int i, State, c, u, v, Head, Tail, Length;
+    char *p;
+    byte b;
     //
-    p1 = 0;
-    while (true)
+    MemSet (Multi, 0, sizeof (_StrMulti));
+    Multi->Mode = StrPosMode;
+    StrAssign (&Multi->Targets, Targets);
+    Length = StrLength (Targets);
+    Multi->Pattern = (char **) malloc (sizeof (char *) * (Length / 2 + 1));
+    // Split the Targets
+    for (p = Multi->Targets; p && *p;)
+      if (*p == ' ')
+        *p++ = 0;
+      else
+        {
+          Multi->Pattern [Multi->Patterns++] = p;
+          while (*p && *p != ' ')
+            p++;
+        }
+    if (StrPosMode == spmWild)
       {
-        // Step space
-        while (Targets [p1] == ' ')
-          p1++;
-        // Are we done?
-        if (Targets [p1] == 0)
-          break;
-        // Find next section in Target
-        p2 = StrPosChFrom (Targets, p1, ' ');
-        if (p2 < 0)
-          p2 = StrLength (Targets);
-        // Look for that section in St
-        c = Targets [p2];
-        Targets [p2] = 0;
-        Res = StrPos (St, &Targets [p1], StrPosMode);
-        Targets [p2] = c;
-        // Is it there?
-        if (Res >= 0)   // found?
-          return true;
-        // Go onto next section
-        p1 = p2;
+        Multi->Wild = (_StrWild *) malloc (sizeof (_StrWild) * (Multi->Patterns + 1));
+        for (i = 0; i < Multi->Patterns; i++)
+          if (!StrWildCompile (&Multi->Wild [i], Multi->Pattern [i]))
+            Multi->Wild [i].Count = -1;   // Too long: use StrMatch
+        return;
+      }
+    // Character classes
+    Multi->Classes = 1;
+    for (i = 0; i < Multi->Patterns; i++)
+      for (p = Multi->Pattern [i]; *p; p++)
+        {
+          b = StrPosMode == spmNoCase ? UpCase (*p) : *p;
+          if (Multi->Class [b] == 0)
+            Multi->Class [b] = Multi->Classes++;
+        }
+    if (StrPosMode == spmNoCase)
+      for (i = 0; i < 256; i++)
+        Multi->Class [i] = Multi->Class [(byte) UpCase (i)];
+    // Trie
+    Multi->Next = (int *) malloc (sizeof (int) * (Length + 1) * Multi->Classes);
+    Multi->Out = (int *) malloc (sizeof (int) * (Length + 1));
+    Multi->OutLink = (int *) malloc (sizeof (int) * (Length + 1));
+    Multi->States = 1;
+    for (i = 0; i < Multi->Classes; i++)
+      Multi->Next [i] = -1;
+    Multi->Out [0] = -1;
+    for (i = 0; i < Multi->Patterns; i++)
+      {
+        State = 0;
+        for (p = Multi->Pattern [i]; *p; p++)
+          {
+            c = Multi->Class [(byte) *p];
+            if (Multi->Next [State * Multi->Classes + c] < 0)
+              {
+                v = Multi->States++;
+                for (u = 0; u < Multi->Classes; u++)
+                  Multi->Next [v * Multi->Classes + u] = -1;
+                Multi->Out [v] = -1;
+                Multi->Next [State * Multi->Classes + c] = v;
+              }
+            State = Multi->Next [State * Multi->Classes + c];
+          }
+        if (Multi->Out [State] < 0)   // The first of any duplicates
+          Multi->Out [State] = i;
+      }
+    // Failure links, breadth first, folded into Next so a search never backs up
+    Fail = (int *) malloc (sizeof (int) * Multi->States);
+    Queue = (int *) malloc (sizeof (int) * Multi->States);
+    Head = 0;
+    Tail = 0;
+    Multi->OutLink [0] = -1;
+    for (c = 0; c < Multi->Classes; c++)
+      if (Multi->Next [c] < 0)
+        Multi->Next [c] = 0;
+      else
+        {
+          v = Multi->Next [c];
+          Fail [v] = 0;
+          Multi->OutLink [v] = -1;
+          Queue [Tail++] = v;
+        }
+    while (Head < Tail)
+      {
+        u = Queue [Head++];
+        for (c = 0; c < Multi->Classes; c++)
+          {
+            v = Multi->Next [u * Multi->Classes + c];
+            if (v < 0)
+              Multi->Next [u * Multi->Classes + c] = Multi->Next [Fail [u] * Multi->Classes + c];
+            else
+              {
+                Fail [v] = Multi->Next [Fail [u] * Multi->Classes + c];
+                Multi->OutLink [v] = Multi->Out [Fail [v]] >= 0 ? Fail [v] : Multi->OutLink [Fail [v]];
+                Queue [Tail++] = v;
+              }
+          }
+      }
+    free (Fail);
+    free (Queue);
+  }
+
+void StrMultiFree (_StrMulti *Multi)
+  {
+    free (Multi->Pattern);
+    free (Multi->Targets);
+    free (Multi->Next);
+    free (Multi->Out);
+    free (Multi->OutLink);
+    free (Multi->Wild);
+    MemSet (Multi, 0, sizeof (_StrMulti));
+  }
+
+unsigned int StrMultiWildMatch (_StrMulti *Multi, int i, char *St)
+  {
+    if (Multi->Wild [i].Count < 0)
+      return StrMatch (St, Multi->Pattern [i], 0, spmWild);
+    return StrWildMatch (&Multi->Wild [i], St);
+  }
+
+// Every match from Start, in the order they end (spmWild: the order they start)
+// Returns the number of matches
+int StrMultiScan (_StrMulti *Multi, char *St, unsigned int Start, _StrMultiCallback *CallBack, void *Data)
+  {
+    int State, Out, i, Res;
+    char *p;
+    //
+    Res = 0;
+    if (St == NULL)
+      return 0;
+    if (Multi->Wild)
+      {
+        for (p = &St [Start]; true; p++)
+          {
+            for (i = 0; i < Multi->Patterns; i++)
+              if (StrMultiWildMatch (Multi, i, p))
+                {
+                  Res++;
+                  if (CallBack && !CallBack (i, p - St, Data))
+                    return Res;
+                }
+            if (*p == 0)
+              break;
+          }
+        return Res;
+      }
+    if (Multi->States == 0)
+      return 0;
+    State = 0;
+    for (p = &St [Start]; *p; p++)
+      {
+        State = Multi->Next [State * Multi->Classes + Multi->Class [(byte) *p]];
+        for (Out = Multi->Out [State] >= 0 ? State : Multi->OutLink [State]; Out > 0; Out = Multi->OutLink [Out])
+          {
+            i = Multi->Out [Out];
+            Res++;
+            if (CallBack && !CallBack (i, p - St + 1 - StrLength (Multi->Pattern [i]), Data))
+              return Res;
+          }
       }
+    return Res;
+  }
+
+bool StrMultiFirst (int Pattern, unsigned int Pos, void *Data)
+  {
+    ((unsigned int *) Data) [0] = Pos;
+    ((unsigned int *) Data) [1] = Pattern;
     return false;
   }
 
+// First match from Start (the first to end, the longest if several end together. spmWild: the first to start)
+// Returns where it starts, -1 if not found. Pattern: which one, may be NULL
+unsigned int StrMultiPosFrom (_StrMulti *Multi, char *St, unsigned int Start, int *Pattern)
+  {
+    unsigned int Found [2];
+    //
+    Found [0] = -1;
+    Found [1] = -1;
+    StrMultiScan (Multi, St, Start, StrMultiFirst, Found);
+    if (Pattern)
+      *Pattern = Found [1];
+    return Found [0];
+  }
+
+// StrPosMulti: Targets: multiple, space separated
+// Builds the automaton each call. To try the same Targets on many strings,
+// keep a _StrMulti of your own: StrMultiBuild once, then StrMultiPosFrom/StrMultiScan
+bool StrPosMulti (char *St, char *Targets, _StrPosMode StrPosMode)
+  {
+    _StrMulti Multi;
+    bool Res;
+    //
+    StrMultiBuild (&Multi, Targets, StrPosMode);
+    Res = StrMultiPosFrom (&Multi, St, 0, NULL) != (unsigned int) -1;
+    StrMultiFree (&Multi);
+    return Res;
+  }
+
 
 /////////////////////////////////////////////////////////////////////////////
 //
@@ -761,6 +1869,423 @@ int StrInArray (char *Array [], char *Target)
 */
 
 
+/////////////////////////////////////////////////////////////////////////////
+//
+// Decimal to Double: Eisel-Lemire (Daniel Lemire, "Number Parsing at a Gigabyte per Second",
+// 2021, with Mushtak and Lemire, "Fast Number Parsing Without Fallback", 2023)
+//   W * 10^Q correctly rounded, for W of up to 19 digits, from one or two 64 x 64 bit products.
+
+const double Power10Exact [23] =   // Exact as doubles
+  {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+  };
+
+#define Power5Min -342
+#define Power5Max 308
+
+// 5^q for q = -342 .. 308, normalised to 128 bits (high word first), rounded up when q < 0
+const unsigned long long Power5Table [2 * (Power5Max - Power5Min + 1)] =
+  {
+    0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL, 0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+    0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL, 0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+    0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL, 0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+    0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL, 0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+    0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL, 0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+    0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL, 0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+    0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL, 0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+    0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, 0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+    0x84a57695fe98746dULL, 0x014bb630f7604b57ULL, 0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+    0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL, 0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+    0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL, 0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+    0xfd00b897478238d0ULL, 0x8920b098955522b4ULL, 0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+    0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL, 0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+    0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL, 0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+    0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL, 0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+    0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, 0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+    0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL, 0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+    0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL, 0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+    0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL, 0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+    0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL, 0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+    0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL, 0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+    0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL, 0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+    0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL, 0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+    0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL, 0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+    0xa37fce126597973cULL, 0xe50ff107bab528a0ULL, 0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+    0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL, 0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+    0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL, 0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+    0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL, 0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+    0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL, 0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+    0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL, 0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+    0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL, 0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+    0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL, 0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+    0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL, 0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+    0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL, 0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+    0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL, 0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+    0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, 0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+    0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL, 0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+    0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL, 0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+    0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL, 0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+    0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL, 0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+    0xc987434744ac874eULL, 0xa327ffb266b56220ULL, 0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+    0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL, 0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+    0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL, 0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+    0xc0314325637a1939ULL, 0xfa911155fefb5308ULL, 0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+    0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL, 0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+    0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL, 0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+    0xb749faed14125d36ULL, 0xcef980ec671f667bULL, 0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+    0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL, 0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+    0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL, 0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+    0xaecc49914078536dULL, 0x58fae9f773886e18ULL, 0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+    0x888f99797a5e012dULL, 0x6d8406c952429603ULL, 0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+    0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL, 0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+    0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL, 0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+    0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL, 0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+    0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL, 0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+    0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL, 0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+    0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL, 0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+    0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL, 0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+    0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL, 0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+    0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, 0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+    0xb913179899f68584ULL, 0x28e2557b59846e3fULL, 0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+    0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL, 0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+    0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL, 0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+    0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL, 0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+    0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL, 0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+    0xd77485cb25823ac7ULL, 0x7d633293366b828bULL, 0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+    0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL, 0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+    0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, 0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+    0xcd795be870516656ULL, 0x67902e276c921f8bULL, 0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+    0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL, 0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+    0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL, 0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+    0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL, 0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+    0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL, 0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+    0xef340a98172aace4ULL, 0x86fb897116c87c34ULL, 0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+    0xbae0a846d2195712ULL, 0x8974836059cca109ULL, 0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+    0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, 0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+    0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL, 0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+    0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL, 0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+    0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL, 0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+    0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, 0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+    0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL, 0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+    0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL, 0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+    0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL, 0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+    0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL, 0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+    0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL, 0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+    0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL, 0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+    0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL, 0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+    0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL, 0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+    0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL, 0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+    0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL, 0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+    0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL, 0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+    0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL, 0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+    0x8c974f7383725573ULL, 0x1e414218c73a13fbULL, 0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+    0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL, 0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+    0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL, 0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+    0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL, 0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+    0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL, 0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+    0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL, 0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+    0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL, 0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+    0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL, 0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+    0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL, 0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+    0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL, 0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+    0xbe89523386091465ULL, 0xf6bbb397f1135823ULL, 0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+    0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, 0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+    0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL, 0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+    0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL, 0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+    0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL, 0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+    0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL, 0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+    0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL, 0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+    0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL, 0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+    0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL, 0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+    0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL, 0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+    0x811ccc668829b887ULL, 0x0806357d5a3f525fULL, 0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+    0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL, 0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+    0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL, 0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+    0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL, 0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+    0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL, 0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+    0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL, 0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+    0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL, 0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+    0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL, 0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+    0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL, 0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+    0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL, 0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+    0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL, 0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+    0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, 0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+    0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL, 0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+    0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL, 0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+    0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL, 0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+    0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL, 0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+    0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL, 0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+    0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL, 0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+    0xc24452da229b021bULL, 0xfbe85badce996168ULL, 0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+    0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, 0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+    0xed246723473e3813ULL, 0x290123e9aab23b68ULL, 0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+    0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL, 0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+    0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL, 0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+    0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, 0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+    0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL, 0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+    0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL, 0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+    0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL, 0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+    0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, 0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+    0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, 0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+    0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, 0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+    0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, 0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+    0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, 0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+    0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, 0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+    0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, 0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+    0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, 0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+    0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, 0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+    0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, 0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+    0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, 0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+    0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, 0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+    0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, 0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+    0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, 0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+    0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, 0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+    0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, 0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+    0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, 0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+    0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, 0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+    0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, 0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+    0xc612062576589ddaULL, 0x95364afe032a819eULL, 0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+    0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, 0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+    0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, 0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+    0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, 0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+    0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, 0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+    0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, 0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+    0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, 0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+    0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, 0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+    0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, 0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+    0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, 0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+    0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, 0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+    0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, 0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+    0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, 0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+    0x8000000000000000ULL, 0x0000000000000000ULL, 0xa000000000000000ULL, 0x0000000000000000ULL,
+    0xc800000000000000ULL, 0x0000000000000000ULL, 0xfa00000000000000ULL, 0x0000000000000000ULL,
+    0x9c40000000000000ULL, 0x0000000000000000ULL, 0xc350000000000000ULL, 0x0000000000000000ULL,
+    0xf424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+    0xbebc200000000000ULL, 0x0000000000000000ULL, 0xee6b280000000000ULL, 0x0000000000000000ULL,
+    0x9502f90000000000ULL, 0x0000000000000000ULL, 0xba43b74000000000ULL, 0x0000000000000000ULL,
+    0xe8d4a51000000000ULL, 0x0000000000000000ULL, 0x9184e72a00000000ULL, 0x0000000000000000ULL,
+    0xb5e620f480000000ULL, 0x0000000000000000ULL, 0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+    0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, 0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+    0xde0b6b3a76400000ULL, 0x0000000000000000ULL, 0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+    0xad78ebc5ac620000ULL, 0x0000000000000000ULL, 0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+    0x878678326eac9000ULL, 0x0000000000000000ULL, 0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+    0xd3c21bcecceda100ULL, 0x0000000000000000ULL, 0x84595161401484a0ULL, 0x0000000000000000ULL,
+    0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, 0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+    0x813f3978f8940984ULL, 0x4000000000000000ULL, 0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+    0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, 0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+    0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, 0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+    0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, 0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+    0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, 0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+    0x96769950b50d88f4ULL, 0x1314448000000000ULL, 0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+    0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+    0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, 0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+    0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, 0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+    0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, 0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+    0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+    0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, 0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+    0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, 0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+    0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, 0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+    0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+    0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, 0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+    0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, 0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+    0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, 0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+    0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, 0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+    0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL, 0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+    0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL, 0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+    0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL, 0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+    0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL, 0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+    0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL, 0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+    0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL, 0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+    0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL, 0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+    0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, 0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+    0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL, 0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+    0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL, 0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+    0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL, 0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+    0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, 0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+    0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL, 0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+    0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL, 0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+    0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL, 0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+    0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, 0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+    0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL, 0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+    0x924d692ca61be758ULL, 0x593c2626705f9c56ULL, 0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+    0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL, 0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+    0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL, 0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+    0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL, 0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+    0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL, 0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+    0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL, 0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+    0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, 0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+    0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL, 0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+    0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL, 0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+    0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL, 0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+    0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL, 0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+    0x9ae757596946075fULL, 0x3375788de9b06958ULL, 0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+    0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL, 0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+    0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL, 0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+    0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, 0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+    0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL, 0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+    0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL, 0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+    0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL, 0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+    0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL, 0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+    0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL, 0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+    0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL, 0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+    0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL, 0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+    0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, 0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+    0x802221226be55a64ULL, 0xc2494954da2c9789ULL, 0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+    0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL, 0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+    0x9c69a97284b578d7ULL, 0xff2a760414536efbULL, 0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+    0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, 0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+    0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL, 0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+    0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL, 0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+    0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL, 0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+    0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, 0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+    0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL, 0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+    0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL, 0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+    0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL, 0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+    0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL, 0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+    0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL, 0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+    0xa59bc234db398c25ULL, 0x43fab9837e699095ULL, 0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+    0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL, 0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+    0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL, 0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+    0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL, 0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+    0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL, 0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+    0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL, 0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+    0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, 0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+    0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL, 0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+    0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL, 0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+    0x8fa475791a569d10ULL, 0xf96e017d694487bcULL, 0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+    0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, 0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+    0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL, 0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+    0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL, 0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+    0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL, 0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+    0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, 0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+    0x82a45b450226b39cULL, 0xecc0024661173473ULL, 0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+    0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL, 0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+    0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL, 0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+    0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL, 0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+    0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL, 0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+    0x98165af37b2153deULL, 0xc3727a337a8b704aULL, 0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+    0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL, 0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+    0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL, 0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+    0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL, 0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+    0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL, 0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+    0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL, 0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+    0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL, 0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+    0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL, 0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+    0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL, 0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+    0x83ea2b892091e44dULL, 0x934aed0aab460432ULL, 0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+    0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL, 0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+    0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL, 0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+    0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL, 0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+    0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL, 0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+    0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, 0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+    0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL, 0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+    0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL, 0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+    0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL, 0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+    0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, 0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+    0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL, 0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+    0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL, 0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+    0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL, 0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+    0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL, 0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+    0x8533285c936b35deULL, 0xd53a88958f87275fULL, 0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+    0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL, 0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+    0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL, 0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+    0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL, 0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+    0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL, 0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+    0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL, 0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+    0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL, 0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+    0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL, 0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+    0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL, 0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+    0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL, 0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+    0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL, 0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+    0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, 0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+    0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL, 0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+    0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL, 0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+    0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL, 0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+    0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL, 0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+    0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL, 0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+    0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL, 0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+    0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL, 0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+    0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, 0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+    0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL, 0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+    0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL, 0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+    0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL, 0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+    0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, 0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+    0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL, 0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+    0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL
+  };
+
+void Multiply128 (unsigned long long a, unsigned long long b, unsigned long long *High, unsigned long long *Low)
+  {
+    #ifdef __SIZEOF_INT128__
+    unsigned __int128 p;
+    //
+    p = (unsigned __int128) a * b;
+    *High = p >> 64;
+    *Low = (unsigned long long) p;
+    #else
+    unsigned long long ah, al, bh, bl, ahbl, albh, t;
+    //
+    ah = a >> 32;
+    al = a & 0xFFFFFFFF;
+    bh = b >> 32;
+    bl = b & 0xFFFFFFFF;
+    ahbl = ah * bl;
+    albh = al * bh;
+    t = ((al * bl) >> 32) + (ahbl & 0xFFFFFFFF) + (albh & 0xFFFFFFFF);
+    *High = ah * bh + (ahbl >> 32) + (albh >> 32) + (t >> 32);
+    *Low = a * b;
+    #endif
+  }
+
+// Bits of the positive double nearest W * 10^Q
+unsigned long long DecimalToDouble (unsigned long long W, int Q)
+  {
+    unsigned long long High, Low, High2, Low2, Mantissa;
+    int Index, Zeros, Upper, Shift, Power2;
+    //
+    if (W == 0 || Q < Power5Min)
+      return 0;
+    if (Q > Power5Max)
+      return 0x7FF0000000000000ULL;   // Infinity
+    Zeros = 64 - BitLength (W);
+    W <<= Zeros;
+    Index = 2 * (Q - Power5Min);
+    Multiply128 (W, Power5Table [Index], &High, &Low);
+    if ((High & 0x1FF) == 0x1FF)   // Rounding bits in doubt: add the low word's product
+      {
+        Multiply128 (W, Power5Table [Index + 1], &High2, &Low2);
+        Low += High2;
+        if (High2 > Low)
+          High++;
+      }
+    Upper = High >> 63;
+    Shift = Upper + 9;
+    Mantissa = High >> Shift;   // 54 or 55 bits: mantissa, then a rounding bit
+    Power2 = (((152170 + 65536) * Q) >> 16) + 63 + Upper - Zeros + 1023;   // floor (Q * log2 (10)) + 63
+    if (Power2 <= 0)   // Subnormal
+      {
+        if (1 - Power2 >= 64)
+          return 0;
+        Mantissa >>= 1 - Power2;
+        Mantissa += Mantissa & 1;
+        return Mantissa >> 1;   // A carry into bit 52 makes the smallest normal
+      }
+    if (Low <= 1 && Q >= -4 && Q <= 23 && (Mantissa & 3) == 1 && (Mantissa << Shift) == High)
+      Mantissa &= ~1ULL;   // Exactly half way: round to even
+    Mantissa += Mantissa & 1;
+    Mantissa >>= 1;
+    if (Mantissa >= (2ULL << 52))
+      {
+        Mantissa = 1ULL << 52;
+        Power2++;
+      }
+    if (Power2 >= 0x7FF)
+      return 0x7FF0000000000000ULL;
+    return (Mantissa & ~(1ULL << 52)) | ((unsigned long long) Power2 << 52);
+  }
+
+
 /////////////////////////////////////////////////////////////////////////////
 //
 // String Parsing
@@ -777,22 +2302,54 @@ void StepSpace (char **Pos)
 // Get an item from a tab / cr / crlf separated string
 // Return the terminating character (after stepping past it
 //
+// Address of the end of the item at St: the first control character (the 0 at the latest), or ',' if Comma
+#ifdef LibFast
+LibNoSanitize char *StrScanItem (const char *St, bool Comma)
+  {
+    const char *p;
+    _LibChunk c, Sep;
+    _LibMask m;
+    //
+    Sep = LibSplat (Comma ? ',' : 0);
+    p = (const char *) ((uintptr_t) St & ~(uintptr_t) (LibChunkSize - 1));
+    c = LibLoad (p);
+    m = (LibMaskLess (c, ' ') | LibMaskEq (c, Sep)) & LibMaskFrom (St - p);
+    while (m == 0)
+      {
+        p += LibChunkSize;
+        c = LibLoad (p);
+        m = LibMaskLess (c, ' ') | LibMaskEq (c, Sep);
+      }
+    return (char *) p + LibMaskIndex (m);
+  }
+#else
+char *StrScanItem (const char *St, bool Comma)
+  {
+    while ((byte) *St >= ' ' && !(Comma && *St == ','))
+      St++;
+    return (char *) St;
+  }
+#endif
+
 char StrGetItem (char **Pos, char *Result, int ResultMax, bool Comma)
   {
     unsigned char c;
+    char *p;
+    int Length;
     //
     if ((*Pos == NULL) || (Result == NULL))
       return 0;   // Error No string
-    while (true)
-      {
-        c = **Pos;
-        (*Pos)++;
-        if (c < ' ' || (Comma && c == ','))
-          break;
-        if (--ResultMax > 0)   // Limited result size but continue parsing
-          *Result++ = c;
-      }
-    *Result = 0;   // Terminate result
+    p = StrScanItem (*Pos, Comma);
+    Length = p - *Pos;
+    if (Length > ResultMax - 1)   // Limited result size but continue parsing
+      Length = ResultMax - 1;
+    if (Length > 0)
+      MemMove (Result, *Pos, Length);
+    else
+      Length = 0;
+    Result [Length] = 0;   // Terminate result
+    c = *p;
+    *Pos = p + 1;
     if ((c == cr) && (**Pos == lf))   // step past lf in a crlf pair
       (*Pos)++;
     return c;
@@ -812,29 +2369,80 @@ bool StrExpectChar (char **St, char Ch)
 
 //bool StrGetError;   // Set true if error found in StrGet*
 
-longint StrGetNumBase (char **Pos, int Base)
+#ifdef LibFast
+// Eight digits at a time in a 64 bit word, first digit in the low byte
+LibNoSanitize unsigned long long StrLoad8 (const char *p)   // Caller checks LibPageSafe
   {
-    longint Result;
-    bool OK;
-    int Digit;
+    unsigned long long Res;
     //
-    OK = false;
+    __builtin_memcpy (&Res, p, 8);
+    return Res;
+  }
+
+int StrDigitRun8 (unsigned long long Chunk)   // How many digits does Chunk start with?
+  {
+    unsigned long long x;
+    //
+    x = ((Chunk & 0xF0F0F0F0F0F0F0F0ULL) | (((Chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) ^ 0x3333333333333333ULL;
+    x = (((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x) & 0x8080808080808080ULL;   // Bytes that aren't
+    return x ? __builtin_ctzll (x) >> 3 : 8;
+  }
+
+unsigned int StrDigits8 (unsigned long long Chunk, int n)   // Value of the first n (1..8) digits
+  {
+    if (n < 8)
+      Chunk = (Chunk << (64 - 8 * n)) | (0x3030303030303030ULL >> (8 * n));   // Leading 0s
+    Chunk -= 0x3030303030303030ULL;
+    Chunk = (Chunk * 10) + (Chunk >> 8);   // Pairs
+    return (((Chunk & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32))) +
+            (((Chunk >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+  }
+#endif
+
+longint StrGetNumBase (char **Pos, int Base)   // -1 if no digits or more than a longint
+  {
+    unsigned long long Result, x;
+    bool Overflow;
+    int Digit, n;
+    char *p;
+    //
+    Overflow = false;
     StepSpace (Pos);
+    p = *Pos;
     Result = 0;
+    #ifdef LibFast
+    if (Base == 10)
+      while (Result < 10000000000ULL && LibPageSafe (p))   // Can't overflow
+        {
+          x = StrLoad8 (p);
+          n = StrDigitRun8 (x);
+          if (n < 4)   // Shorter is quicker a byte at a time
+            break;
+          Result = Result * Power10Table [n] + StrDigits8 (x, n);
+          p += n;
+          if (n < 8)
+            break;
+        }
+    #endif
     while (true)
       {
-        Digit = GetDigit (**Pos);
+        Digit = GetDigit (*p);
         if (Digit < 0)
           break;
         if (Digit >= Base)
           break;
+        if (Result >= 0x0200000000000000ULL && Result > (0x7FFFFFFFFFFFFFFFULL - Digit) / Base)   // Below 2^57 can't overflow
+          Overflow = true;   // Keep going to step past the number
         Result = (Result * Base) + Digit;
-        (*Pos)++;
-        OK = true;
+        p++;
       }
-    if (!OK)
-      return -1;
-      //StrGetError = true;
+    if (p == *Pos || Overflow)
+      {
+        *Pos = p;
+        return -1;
+        //StrGetError = true;
+      }
+    *Pos = p;
     return Result;
   }
 
@@ -871,73 +2479,211 @@ longint StrGetHex (char **Pos)
     return StrGetNumBase (Pos, 16);
   }
 
-double StrGetReal (char **Pos)
+#define StrGetRealDigits 19   // Significant digits held in W
+#define StrGetRealMaxDigits 780   // Digits after these only matter if not all 0
+
+// W was cut short and its last digit matters: let strtod read them all
+double StrGetRealLong (char *St, char *End, longint Exp)   // [St, End) digits and '.', * 10^Exp
   {
-    bool n;   // negative?
-    bool d;   // decimal point encountered
-    int Exp, e;   // exponent
-    char c;
-    double Result;
+    char Buf [StrGetRealMaxDigits + 32], *p, *q, c;
+    int Digits;
+    bool Point, Sticky;
     //
-    // Note Sign
-    StepSpace (Pos);
-    n = false;
-    if (**Pos == '-')
-      {
-        (*Pos)++;
-        n = true;
-      }
+    p = Buf;
+    Digits = 0;
+    Point = false;
+    Sticky = false;
+    for (; St < End; St++)
+      if (*St == '.')
+        Point = true;
+      else
+        {
+          if (Point)
+            Exp--;
+          if (Digits || *St != '0')
+            {
+              if (Digits < StrGetRealMaxDigits)
+                *p++ = *St;
+              else
+                {
+                  Exp++;
+                  Sticky |= *St != '0';
+                }
+              Digits++;
+            }
+        }
+    if (Sticky)
+      {
+        *p++ = '1';
+        Exp--;
+      }
+    *p++ = 'e';
+    if (Exp < 0)
+      {
+        *p++ = '-';
+        Exp = -Exp;
+      }
+    q = p;
+    do
+      {
+        *p++ = '0' + Exp % 10;
+        Exp /= 10;
+      }
+    while (Exp);
+    *p-- = 0;
+    while (q < p)   // Reverse the exponent digits
+      {
+        c = *q;
+        *q++ = *p;
+        *p-- = c;
+      }
+    return strtod (Buf, NULL);
+  }
+
+double StrGetReal (char **Pos)
+  {
+    union
+      {
+        double d;
+        unsigned long long u;
+      } Bits;
+    bool n;   // negative?
+    bool d;   // decimal point encountered
+    bool Truncated;   // nonzero digits left out of w
+    bool m;   // negative exponent?
+    unsigned long long w, x;   // first 19 significant digits
+    longint Exp, e;   // exponent
+    int Digits, Run, k;   // Run: digits in a row so far
+    char c, *p, *Start, *End;
+    //
+    // Note Sign
+    StepSpace (Pos);
+    n = false;
+    if (**Pos == '-')
+      {
+        (*Pos)++;
+        n = true;
+      }
     else if (**Pos == '+')
       (*Pos)++;
-    // Read value of all mantissa digits. Adjust exponent if decimal point present
-    Result = 0.0;
+    // Read the mantissa digits into w. Adjust exponent for the decimal point and digits left out
+    p = *Pos;
+    Start = p;
+    w = 0;
+    Digits = 0;
     Exp = 0;
     d = false;
+    Truncated = false;
+    while (*p == '0')   // Leading 0s don't count
+      p++;
+    if (*p == '.')
+      {
+        p++;
+        d = true;
+        while (*p == '0')
+          {
+            p++;
+            Exp--;
+          }
+      }
+    Run = 0;
     while (true)
       {
-        c = **Pos;
-        if (c == 0)
-          break;
+        #ifdef LibFast
+        if (Run == 4 && Digits <= StrGetRealDigits - 8 && LibPageSafe (p))   // Short numbers are quicker a byte at a time
+          {
+            x = StrLoad8 (p);
+            k = StrDigitRun8 (x);
+            if (k)
+              {
+                w = w * Power10Table [k] + StrDigits8 (x, k);
+                p += k;
+                Digits += k;
+                if (d)
+                  Exp -= k;
+                if (k == 8)
+                  continue;
+              }
+            Run++;
+          }
+        #endif
+        c = *p;
         if (IsDigit (c))
           {
-            (*Pos)++;
-            Result = (Result * 10.0) + GetDigit (c);
-            if (d)
-              Exp--;
+            p++;
+            Run++;
+            if (Digits < StrGetRealDigits)
+              {
+                w = (w * 10) + (c - '0');
+                Digits++;
+                if (d)
+                  Exp--;
+              }
+            else
+              {
+                Truncated |= c != '0';
+                if (!d)
+                  Exp++;
+              }
           }
-        else if (c == '.')
+        else if (c == '.' && !d)
           {
-            (*Pos)++;
+            p++;
             d = true;
+            Run = 0;
           }
         else
+          break;
+      }
+    End = p;
+    *Pos = p;
+    e = 0;
+    if (UpCase (*p) == 'E')   // Adjusting exponent if Scientific Notation present
+      {
+        p++;
+        m = false;
+        if (*p == '+')
+          p++;
+        else if (*p == '-')
+          {
+            p++;
+            m = true;
+          }
+        if (IsDigit (*p))   // Else the 'e' is not part of the number (as strtod)
           {
-            if (UpCase (c) == 'E')   // Adjusting exponent if Scientific Notation present
+            while (IsDigit (*p))
               {
-                (*Pos)++;
-                e = StrGetInt (Pos);
-                if (e == StrGetIntError)
-                  return 0.0 / 0.0; //NAN;
-                Exp = Exp + e;
+                if (e <= 100000)   // Well past overflow or underflow
+                  e = e * 10 + *p - '0';
+                p++;
               }
-            break;
+            if (e > 100000)
+              e = 100000;
+            if (m)
+              e = -e;
+            *Pos = p;
           }
       }
-    // Apply multiplier
-    while (Exp < 0)
-      {
-        Result = Result / 10.0;
-        Exp++;
-      }
-    while (Exp > 0)
+    Exp += e;
+    if (Exp > Power5Max)
+      Exp = Power5Max + 1;
+    else if (Exp < Power5Min)
+      Exp = Power5Min - 1;
+    // Round to the nearest double
+    #if !defined (__FLT_EVAL_METHOD__) || __FLT_EVAL_METHOD__ == 0
+    if (!Truncated && w <= (1ULL << 53) && Exp >= -22 && Exp <= 22)   // Both exact: one rounding (Clinger)
+      Bits.d = Exp < 0 ? (double) w / Power10Exact [-Exp] : (double) w * Power10Exact [Exp];
+    else
+    #endif
       {
-        Result = Result * 10.0;
-        Exp--;
+        Bits.u = DecimalToDouble (w, Exp);
+        if (Truncated && Bits.u != DecimalToDouble (w + 1, Exp))
+          Bits.d = StrGetRealLong (Start, End, e);
       }
     // Apply Sign
     if (n)
-      Result = -Result;
-    return Result;
+      Bits.d = -Bits.d;
+    return Bits.d;
   }
 
 unsigned int StrGetHexAscii (char **Pos, byte *Data, unsigned int MaxData)
@@ -1044,6 +2790,169 @@ int StrToInt (char *St)
   }
 
 
+/////////////////////////////////////////////////////////////////////////////
+//
+// Delimited Records: tab / comma separated text split in place
+//   Fields end as StrGetItem's items do, records at a cr, lf, crlf or the 0.
+//   Fields are views into the text: nothing is copied or terminated.
+
+typedef struct
+  {
+    char *St;   // Not terminated
+    int Length;
+  } _StrField;
+
+typedef struct
+  {
+    _StrField *Field;
+    int Count;
+    int Allocated;
+  } _StrRecord;
+
+// Called for each record, Line counting from 0. Return false to stop
+typedef bool _StrRecordCallback (_StrRecord *Record, unsigned int Line, void *Data);
+
+// StrGetItem without the copy
+char StrGetField (char **Pos, _StrField *Field, bool Comma)
+  {
+    unsigned char c;
+    char *p;
+    //
+    if (*Pos == NULL)
+      return 0;   // Error No string
+    p = StrScanItem (*Pos, Comma);
+    Field->St = *Pos;
+    Field->Length = p - *Pos;
+    c = *p;
+    *Pos = p + 1;
+    if ((c == cr) && (**Pos == lf))   // step past lf in a crlf pair
+      (*Pos)++;
+    return c;
+  }
+
+void StrRecordInit (_StrRecord *Record)
+  {
+    Record->Field = NULL;
+    Record->Count = 0;
+    Record->Allocated = 0;
+  }
+
+void StrRecordFree (_StrRecord *Record)
+  {
+    free (Record->Field);
+    StrRecordInit (Record);
+  }
+
+// All the fields of a line
+// Return the terminating character (cr, lf or 0) after stepping past it
+// Out of memory: returns 0 with Record->Count 0
+char StrGetRecord (char **Pos, _StrRecord *Record, bool Comma)
+  {
+    _StrField *Field;
+    char c;
+    //
+    Record->Count = 0;
+    if (*Pos == NULL)
+      return 0;   // Error No string
+    do
+      {
+        if (Record->Count == Record->Allocated)
+          {
+            Field = (_StrField *) realloc (Record->Field, (Record->Allocated ? 2 * Record->Allocated : 16) * sizeof (_StrField));
+            if (Field == NULL)   // Record->Field is as it was
+              {
+                Record->Count = 0;
+                return 0;
+              }
+            Record->Field = Field;
+            Record->Allocated = Record->Allocated ? 2 * Record->Allocated : 16;
+          }
+        c = StrGetField (Pos, &Record->Field [Record->Count++], Comma);
+      }
+    while (c != 0 && c != cr && c != lf);
+    return c;
+  }
+
+// Every record to the end of the string, leaving Pos on the 0. Returns the number read
+unsigned int StrForEachRecord (char **Pos, bool Comma, _StrRecordCallback *CallBack, void *Data)
+  {
+    _StrRecord Record;
+    unsigned int Line;
+    char c;
+    //
+    StrRecordInit (&Record);
+    Line = 0;
+    if (*Pos)
+      while (**Pos)
+        {
+          c = StrGetRecord (Pos, &Record, Comma);
+          if (c == 0 && Record.Count == 0)   // Out of memory
+            break;
+          Line++;
+          if (c == 0)
+            (*Pos)--;   // Stay on the 0
+          if (CallBack && !CallBack (&Record, Line - 1, Data))
+            break;
+        }
+    StrRecordFree (&Record);
+    return Line;
+  }
+
+// Does [p, End) start like a number? Keeps StrGet* from looking past an empty field
+bool StrFieldIsNumber (char *p, char *End)
+  {
+    while (p < End && *p == ' ')
+      p++;
+    if (p < End && (*p == '-' || *p == '+'))
+      p++;
+    if (p < End && *p == '.')
+      p++;
+    return p < End && IsDigit (*p);
+  }
+
+bool StrFieldReal (_StrField *Field, double *Value)   // false if not a number
+  {
+    char *p, *End;
+    //
+    p = Field->St;
+    End = p + Field->Length;
+    if (!StrFieldIsNumber (p, End))
+      return false;
+    *Value = StrGetReal (&p);
+    while (p < End && *p == ' ')
+      p++;
+    return p == End;
+  }
+
+bool StrFieldInt (_StrField *Field, longint *Value)   // false if not a number
+  {
+    char *p, *End;
+    //
+    p = Field->St;
+    End = p + Field->Length;
+    if (!StrFieldIsNumber (p, End))
+      return false;
+    *Value = StrGetInt (&p);
+    while (p < End && *p == ' ')
+      p++;
+    return p == End && *Value != (longint) StrGetIntError;
+  }
+
+// Values [i] for each field, NaN if not a number. Returns how many were numbers
+int StrRecordReals (_StrRecord *Record, double *Values)
+  {
+    int i, Res;
+    //
+    Res = 0;
+    for (i = 0; i < Record->Count; i++)
+      if (StrFieldReal (&Record->Field [i], &Values [i]))
+        Res++;
+      else
+        Values [i] = 0.0 / 0.0; //NAN;
+    return Res;
+  }
+
+
 /////////////////////////////////////////////////////////////////////////////
 //
 // Build String: Format items into a string, adjusting the pointer
@@ -1099,57 +3008,96 @@ unsigned int StrToStr (char **Dest, char *Source)
 #define IntToLengthCommas 0x40
 #define IntToLength 0x3F
 
+const char DigitChars [] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+const char DigitPairs [] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
 int IntToStrBase (char **Dest, longint n, byte Length, byte Base)   // Length: b0-b5 Size. + 0x80 pad with '0'. + 0x40 include commas/hyphens
   {
-    longint n_;
-    int i, j;
-    char temp [128];
-    int x;
+    unsigned long long n_;
+    int Digits, Size, Pad, Shift, j;
+    char *p, Separator;
     //
     n_ = n;
     if (n < 0)   // Negative
       {
-        n_ = -n;
+        n_ = 0 - n_;
         Length &= ~IntToLengthZeros;   // Negative numbers pad with spaces
       }
-    // Convert to decimal characters (in reverse order)
-    i = sizeof (temp);
-    temp [--i] = 0;   // terminate
-    j = 0;
-    do
+    // Work out the size first, then write it in place
+    Digits = DigitCount (n_, Base);
+    Size = Digits + (n < 0);
+    Separator = 0;
+    if (Length & IntToLengthCommas)   // commas every 3 / hyphens every 4
       {
-        x = (n_ % Base);
-        if (x < 10)
-          temp [--i] = x + '0';
-        else
-          temp [--i] = x - 10 + 'A';
-        j++;
-        n_ = n_ / Base;
-        if (n_ == 0)
-          break;
-        if (Length & IntToLengthCommas)   // commas / hyphens
-          if (Base == 10)
-            {
-              if (j % 3 == 0)
-                temp [--i] = ',';
-            }
-          else if (j % 4 == 0)
-            temp [--i] = '-';
+        Separator = Base == 10 ? ',' : '-';
+        Size += (Digits - 1) / (Base == 10 ? 3 : 4);
       }
-    while (n_);
-    // Negative sign
-    if (n < 0)
-      temp [--i] = '-';
-    // Pad out requested spaces
-    while ((byte) (sizeof (temp) - 1 - i) < (Length & 0x3F))
+    Pad = (Length & IntToLength) - Size;
+    if (Pad < 0)
+      Pad = 0;
+    if (*Dest == NULL)
+      return Pad + Size;
+    p = *Dest;
+    MemSet (p, Length & IntToLengthZeros ? '0' : ' ', Pad);
+    p += Pad;
+    if (n < 0)   // Negative sign
+      *p++ = '-';
+    *Dest = p + Size - (n < 0);
+    p = *Dest;   // Digits go in backwards from here
+    if (Separator)
+      {
+        j = 0;
+        while (true)
+          {
+            *--p = DigitChars [n_ % Base];
+            n_ /= Base;
+            if (n_ == 0)
+              break;
+            if (++j == (Base == 10 ? 3 : 4))
+              {
+                *--p = Separator;
+                j = 0;
+              }
+          }
+      }
+    else if (Base == 10)   // Two at a time
       {
-        if (Length & IntToLengthZeros)
-          temp [--i] = '0';
+        while (n_ >= 100)
+          {
+            j = (n_ % 100) * 2;
+            n_ /= 100;
+            *--p = DigitPairs [j + 1];
+            *--p = DigitPairs [j];
+          }
+        if (n_ >= 10)
+          {
+            *--p = DigitPairs [n_ * 2 + 1];
+            *--p = DigitPairs [n_ * 2];
+          }
         else
-          temp [--i] = ' ';
+          *--p = n_ + '0';
+      }
+    else if ((Base & (Base - 1)) == 0)   // Power of 2: shift & mask
+      {
+        Shift = BitLength (Base) - 1;
+        do
+          {
+            *--p = DigitChars [n_ & (Base - 1)];
+            n_ >>= Shift;
+          }
+        while (n_);
       }
-    // Add decimal characters to result (in correct order)
-    return StrToStr (Dest, &temp [i]);
+    else
+      do
+        {
+          *--p = DigitChars [n_ % Base];
+          n_ /= Base;
+        }
+      while (n_);
+    return Pad + Size;
   }
 
 int IntToStrFill (char **Dest, longint n, byte Digits)
@@ -1263,137 +3211,362 @@ double Power10 (int Exp)
     double Val;
     //
     Val = 1.0;
-    while (Exp > 0)
+    while (Exp > 22)
       {
-        Val *= 10.0;
-        Exp--;
+        Val *= 1e22;
+        Exp -= 22;
       }
-    while (Exp < 0)
+    while (Exp < -22)
       {
-        Val /= 10.0;
-        Exp++;
+        Val /= 1e22;
+        Exp += 22;
       }
-    return Val;
+    if (Exp >= 0)
+      return Val * Power10Exact [Exp];
+    return Val / Power10Exact [-Exp];
   }
 
-#define FlagsCommas 0x01
 
-int RealToStr (char **Dest, double Val, int Decimals, byte Flags)
+/////////////////////////////////////////////////////////////////////////////
+//
+// Real to Digits: Grisu2 (Florian Loitsch, "Printing Floating-Point Numbers Quickly
+// and Accurately with Integers", 2010)
+//   The shortest digits that read back to the same double (rarely one longer).
+//   _DiyFp: F * 2^E with a 64 bit F
+
+typedef struct
+  {
+    unsigned long long F;
+    int E;
+  } _DiyFp;
+
+// 10^k for k = -348, -340 .. 340 as normalised F * 2^E
+const unsigned long long GrisuPowerF [87] =
+  {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+  };
+
+const short GrisuPowerE [87] =
+  {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+  };
+
+_DiyFp DiyFpMultiply (_DiyFp x, _DiyFp y)   // Top 64 bits of the product, rounded
   {
-    int Exp;
-    double Mul, Round;
-    int Dig;   // this digit
-    int Size;   // resultant size
+    unsigned long long a, b, c, d, ac, bc, ad, bd, t;
+    _DiyFp Res;
     //
-    Size = 0;
-    // Negative sign
-    if (Val < 0.0)
+    a = x.F >> 32;
+    b = x.F & 0xFFFFFFFF;
+    c = y.F >> 32;
+    d = y.F & 0xFFFFFFFF;
+    ac = a * c;
+    bc = b * c;
+    ad = a * d;
+    bd = b * d;
+    t = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF) + (1U << 31);
+    Res.F = ac + (ad >> 32) + (bc >> 32) + (t >> 32);
+    Res.E = x.E + y.E + 64;
+    return Res;
+  }
+
+_DiyFp DiyFpNormalize (_DiyFp x)
+  {
+    while (!(x.F & 0x8000000000000000ULL))
       {
-        if (*Dest)
-          *(*Dest)++ = '-';
-        Size++;
-        Val = -Val;
+        x.F <<= 1;
+        x.E--;
       }
-    // Scale Mul, Exp, Round: 10.0 > Val * Mul >= 1.0
-    Exp = 0;
-    Mul = 1.0;
-    Round = 1.0;
-    if (Val)
+    return x;
+  }
+
+void GrisuRound (char *Digits, int Length, unsigned long long Delta, unsigned long long Rest, unsigned long long TenKappa, unsigned long long Distance)
+  {
+    while (Rest < Distance && Delta - Rest >= TenKappa &&
+           (Rest + TenKappa < Distance || Distance - Rest > Rest + TenKappa - Distance))
       {
-        while (Val * Mul >= 10.0)
-          {
-            Mul /= 10.0;
-            Exp++;
-          }
-        while (Val * Mul < 1.0)
-          {
-            Mul *= 10.0;
-            Exp--;
-          }
-        // Round up
-        if (Decimals < 0)   // decimals unspecified, so use significance
-          Round = 5.0 / Mul / Power10 (15);
-        else   // specified
-          Round = 5.0 / Power10 (Decimals + 1);
-        Val += Round;
-        if (Val * Mul > 10.0)
-          {
-            Mul /= 10.0;
-            Exp++;
-          }
+        Digits [Length - 1]--;
+        Rest += TenKappa;
       }
-    // Force unscaled display low numbers
-    if (Mul > 1.0)
+  }
+
+// Digits of a positive, finite Val (at most 17, no 0 added). Val = Digits * 10^*K
+int GrisuDigits (double Val, char *Digits, int *K)
+  {
+    union
+      {
+        double d;
+        unsigned long long u;
+      } Bits;
+    _DiyFp v, Plus, Minus, c, W, Wp, Wm, One;
+    unsigned long long p2, Delta, Distance, Rest;
+    unsigned int p1, d;
+    int Length, Kappa, i;
+    double dk;
+    //
+    Bits.d = Val;
+    v.F = Bits.u & 0x000FFFFFFFFFFFFFULL;
+    v.E = (Bits.u >> 52) & 0x7FF;
+    if (v.E)   // Normal: add the hidden bit
       {
-        Mul = 1.0;
-        Exp = 0;
+        v.F += 0x0010000000000000ULL;
+        v.E -= 1075;
       }
-    // Calculate succesive digits
-    while (true)
+    else
+      v.E = -1074;
+    // Boundaries half way to the neighbouring doubles, on the same exponent
+    Plus.F = (v.F << 1) + 1;
+    Plus.E = v.E - 1;
+    while (!(Plus.F & (0x0010000000000000ULL << 1)))
       {
-        Dig = Val * Mul;
-        if (*Dest)
-          *(*Dest)++ = Dig + '0';   // Add Digit
-        Size++;
-        Val = Val - Dig / Mul;   // remove Digit's value
-        Mul *= 10;
-        if (Decimals < 0)   // "no" limit specified
+        Plus.F <<= 1;
+        Plus.E--;
+      }
+    Plus.F <<= 64 - 52 - 2;
+    Plus.E -= 64 - 52 - 2;
+    if (v.F == 0x0010000000000000ULL)   // The one below is closer
+      {
+        Minus.F = (v.F << 2) - 1;
+        Minus.E = v.E - 2;
+      }
+    else
+      {
+        Minus.F = (v.F << 1) - 1;
+        Minus.E = v.E - 1;
+      }
+    Minus.F <<= Minus.E - Plus.E;
+    Minus.E = Plus.E;
+    // Scale by a cached power of 10 into range
+    dk = (-61 - Plus.E) * 0.30102999566398114 + 347;
+    i = (int) dk;
+    if (dk - i > 0.0)
+      i++;
+    i = (i >> 3) + 1;
+    *K = -(-348 + i * 8);
+    c.F = GrisuPowerF [i];
+    c.E = GrisuPowerE [i];
+    W = DiyFpMultiply (DiyFpNormalize (v), c);
+    Wp = DiyFpMultiply (Plus, c);
+    Wm = DiyFpMultiply (Minus, c);
+    Wm.F++;
+    Wp.F--;
+    // Generate digits from Wp while they stay inside the boundaries
+    Delta = Wp.F - Wm.F;
+    Distance = Wp.F - W.F;
+    One.E = Wp.E;
+    One.F = 1ULL << -One.E;
+    p1 = Wp.F >> -One.E;
+    p2 = Wp.F & (One.F - 1);
+    Kappa = DigitCount (p1, 10);
+    Length = 0;
+    while (Kappa > 0)
+      {
+        switch (Kappa)   // Constant divisors become multiplies
           {
-            if (Exp <= 0)
-              if (Val <= Round + Round)
-                break;
+            case 10: d = p1 / 1000000000; p1 %= 1000000000; break;
+            case 9: d = p1 / 100000000; p1 %= 100000000; break;
+            case 8: d = p1 / 10000000; p1 %= 10000000; break;
+            case 7: d = p1 / 1000000; p1 %= 1000000; break;
+            case 6: d = p1 / 100000; p1 %= 100000; break;
+            case 5: d = p1 / 10000; p1 %= 10000; break;
+            case 4: d = p1 / 1000; p1 %= 1000; break;
+            case 3: d = p1 / 100; p1 %= 100; break;
+            case 2: d = p1 / 10; p1 %= 10; break;
+            default: d = p1; p1 = 0; break;
           }
-        else   // decimals specified
-          if (Decimals == -Exp)
-            break;
-        if (Exp == 0)
+        if (d || Length)
+          Digits [Length++] = '0' + d;
+        Kappa--;
+        Rest = ((unsigned long long) p1 << -One.E) + p2;
+        if (Rest <= Delta)
           {
-            if (*Dest)
-              *(*Dest)++ = '.';
-            Size++;
+            *K += Kappa;
+            GrisuRound (Digits, Length, Delta, Rest, Power10Table [Kappa] << -One.E, Distance);
+            return Length;
           }
-        else if ((Flags & FlagsCommas) && (Exp > 0) && (Exp % 3 == 0))
+      }
+    while (true)
+      {
+        p2 *= 10;
+        Delta *= 10;
+        d = p2 >> -One.E;
+        if (d || Length)
+          Digits [Length++] = '0' + d;
+        p2 &= One.F - 1;
+        Kappa--;
+        if (p2 < Delta)
           {
-            if (*Dest)
-              *(*Dest)++ = ',';
-            Size++;
+            *K += Kappa;
+            GrisuRound (Digits, Length, Delta, p2, One.F, -Kappa < 20 ? Distance * Power10Table [-Kappa] : 0);
+            return Length;
           }
-        Exp--;
       }
-    // Optionally kill trailing zeros
-    return Size;
   }
 
-// DateTimeToStrLocalize:
-// Format DateTime according to Format
-// Format eg "%Y %b %d %H:%M:%S"
+#define FlagsCommas 0x01
 
-bool DateTimeToStrLocalize (char **Dest, time_t DateTime, char *Format)
+// Decimals < 0: shortest that reads back the same. Else rounded (half up) to Decimals places
+// Never an exponent: all the integer digits are written. Returns the size, *Dest NULL just sizes it
+int RealToStr (char **Dest, double Val, int Decimals, byte Flags)
   {
-    char ts [64];
-    struct tm *tmp;
+    char Digits [20];
+    int Length, K, Point, Keep, Size, i;
+    char *p;
     //
-    tmp = localtime (&DateTime);
-    if (tmp)
+    Size = 0;
+    p = *Dest;
+    // Negative sign
+    if (Val < 0.0)
       {
-        strftime (ts, 32, Format, tmp);
-        StrToStr (Dest, ts);
-        return true;
+        if (p)
+          *p++ = '-';
+        Size++;
+        Val = -Val;
       }
-    return false;
-  }
-
-void KeyName (char **Dest, byte Ch)
-  {
-    if (Ch < ' ')
+    if (Val != Val || Val - Val != 0.0)   // NaN or Inf
       {
-        *(*Dest)++ = '^';
-        *(*Dest)++ = Ch + '@';
+        if (p)
+          p = StrCopy (p, Val != Val ? "NaN" : "Inf");
+        *Dest = p;
+        return Size + 3;
       }
-    else if (Ch < 0x80)
-      *(*Dest)++ = Ch;
-    else
-      IntToHex (Dest, Ch, 2);
+    Length = 0;
+    K = 0;
+    if (Val != 0.0)
+      Length = GrisuDigits (Val, Digits, &K);
+    Point = Length + K;   // Digits before the decimal point
+    if (Decimals < 0)
+      {
+        Decimals = Length - Point;
+        if (Decimals < 0)
+          Decimals = 0;
+      }
+    else
+      {
+        Keep = Point + Decimals;
+        if (Keep < Length)   // Round
+          {
+            if (Keep < 0)
+              Length = 0;
+            else
+              {
+                i = Length = Keep;
+                if (Digits [Keep] >= '5')   // Up
+                  {
+                    while (--i >= 0 && Digits [i] == '9')
+                      Length--;   // Trailing zeros aren't needed
+                    if (i >= 0)
+                      Digits [i]++;
+                    else   // All 9s: becomes 1 followed by 0s
+                      {
+                        Digits [0] = '1';
+                        Length = 1;
+                        Point++;
+                      }
+                  }
+              }
+          }
+      }
+    // Integer part
+    if (Point <= 0)
+      {
+        if (p)
+          *p++ = '0';
+        Size++;
+      }
+    else
+      for (i = 0; i < Point; i++)
+        {
+          if ((Flags & FlagsCommas) && i && (Point - i) % 3 == 0)
+            {
+              if (p)
+                *p++ = ',';
+              Size++;
+            }
+          if (p)
+            *p++ = i < Length ? Digits [i] : '0';
+          Size++;
+        }
+    // Fraction
+    if (Decimals)
+      {
+        if (p)
+          {
+            *p++ = '.';
+            for (i = Point; i < Point + Decimals; i++)
+              *p++ = (i >= 0 && i < Length) ? Digits [i] : '0';
+          }
+        Size += 1 + Decimals;
+      }
+    *Dest = p;
+    return Size;
+  }
+
+// DateTimeToStrLocalize:
+// Format DateTime according to Format
+// Format eg "%Y %b %d %H:%M:%S"
+
+bool DateTimeToStrLocalize (char **Dest, time_t DateTime, char *Format)
+  {
+    char ts [64];
+    struct tm *tmp;
+    //
+    tmp = localtime (&DateTime);
+    if (tmp)
+      {
+        strftime (ts, 32, Format, tmp);
+        StrToStr (Dest, ts);
+        return true;
+      }
+    return false;
+  }
+
+void KeyName (char **Dest, byte Ch)
+  {
+    if (Ch < ' ')
+      {
+        *(*Dest)++ = '^';
+        *(*Dest)++ = Ch + '@';
+      }
+    else if (Ch < 0x80)
+      *(*Dest)++ = Ch;
+    else
+      IntToHex (Dest, Ch, 2);
   }
 
 bool IntStrToStrFirst;
@@ -1419,6 +3592,227 @@ int IntStrToStr (char **Dest, longint Num, char *StrSingular, char *StrPlural)
   }
 
 
+/////////////////////////////////////////////////////////////////////////////
+//
+// String Builder: a growing string to add formatted items to
+//   Starts in the small buffer inside the _StrBuilder, then moves to the heap, doubling.
+//   The *ToSb functions mirror the *ToStr ones: make room, then let those write.
+//   St points into the _StrBuilder at first, so don't copy one, pass its address.
+//   Out of memory: the item is not added (its *ToSb returns 0) and Failed is set.
+
+#define StrBuilderInline 64
+#define IntToStrMax 128   // Most IntToStrBase can write
+
+typedef struct
+  {
+    char *St;   // Always 0 terminated
+    unsigned int Length;
+    unsigned int Allocated;
+    bool Failed;   // Something wasn't added: out of memory
+    char Inline [StrBuilderInline];
+  } _StrBuilder;
+
+void StrBuilderInit (_StrBuilder *Sb)
+  {
+    Sb->St = Sb->Inline;
+    Sb->St [0] = 0;
+    Sb->Length = 0;
+    Sb->Allocated = StrBuilderInline;
+    Sb->Failed = false;
+  }
+
+void StrBuilderFree (_StrBuilder *Sb)
+  {
+    if (Sb->St != Sb->Inline)
+      free (Sb->St);
+    StrBuilderInit (Sb);
+  }
+
+// Make room for Size more characters. Returns where they go, NULL if out of memory
+char *StrBuilderReserve (_StrBuilder *Sb, unsigned int Size)
+  {
+    unsigned int Allocated;
+    char *New;
+    //
+    if (Sb->Length + Size + 1 > Sb->Allocated)
+      {
+        Allocated = Sb->Allocated * 2;
+        if (Allocated < Sb->Length + Size + 1)
+          Allocated = Sb->Length + Size + 1;
+        if (Sb->St == Sb->Inline)
+          {
+            New = (char *) malloc (Allocated);
+            if (New)
+              MemMove (New, Sb->St, Sb->Length + 1);
+          }
+        else
+          New = (char *) realloc (Sb->St, Allocated);
+        if (New == NULL)   // Sb->St is as it was
+          {
+            Sb->Failed = true;
+            return NULL;
+          }
+        Sb->St = New;
+        Sb->Allocated = Allocated;
+      }
+    return &Sb->St [Sb->Length];
+  }
+
+// Size characters have been written at the end
+int StrBuilderAdded (_StrBuilder *Sb, int Size)
+  {
+    Sb->Length += Size;
+    Sb->St [Sb->Length] = 0;
+    return Size;
+  }
+
+// Take the string (Caller must free, NULL if out of memory). Sb is left empty
+char *StrBuilderResult (_StrBuilder *Sb)
+  {
+    char *Res;
+    //
+    if (Sb->St == Sb->Inline)
+      {
+        Res = (char *) malloc (Sb->Length + 1);
+        if (Res)
+          MemMove (Res, Sb->St, Sb->Length + 1);
+      }
+    else
+      {
+        Res = (char *) realloc (Sb->St, Sb->Length + 1);
+        if (Res == NULL)   // Couldn't shrink it
+          Res = Sb->St;
+      }
+    StrBuilderInit (Sb);
+    return Res;
+  }
+
+int CharToSb (_StrBuilder *Sb, char Source)
+  {
+    char *p;
+    //
+    p = StrBuilderReserve (Sb, 1);
+    if (p == NULL)
+      return 0;
+    *p = Source;
+    return StrBuilderAdded (Sb, 1);
+  }
+
+int CharToSbRepeat (_StrBuilder *Sb, char Source, int n)
+  {
+    char *p;
+    //
+    p = StrBuilderReserve (Sb, n);
+    if (p == NULL)
+      return 0;
+    MemSet (p, Source, n);
+    return StrBuilderAdded (Sb, n);
+  }
+
+unsigned int StrToSbN (_StrBuilder *Sb, char *Source, unsigned int n)   // Limit to n chars (if n != 0)
+  {
+    unsigned int Size;
+    char *p;
+    //
+    Size = StrLength (Source);
+    if (n && n < Size)
+      Size = n;
+    p = StrBuilderReserve (Sb, Size);
+    if (p == NULL)
+      return 0;
+    MemMove (p, Source, Size);
+    return StrBuilderAdded (Sb, Size);
+  }
+
+unsigned int StrToSb (_StrBuilder *Sb, char *Source)
+  {
+    return StrToSbN (Sb, Source, 0);
+  }
+
+int IntToSbBase (_StrBuilder *Sb, longint n, byte Length, byte Base)
+  {
+    char *p;
+    //
+    p = StrBuilderReserve (Sb, IntToStrMax);
+    if (p == NULL)
+      return 0;
+    return StrBuilderAdded (Sb, IntToStrBase (&p, n, Length, Base));
+  }
+
+int IntToSbFill (_StrBuilder *Sb, longint n, byte Digits)
+  {
+    return IntToSbBase (Sb, n, Digits, 10);
+  }
+
+int IntToSb (_StrBuilder *Sb, longint n)
+  {
+    return IntToSbBase (Sb, n, 0, 10);
+  }
+
+int IntToHexSb (_StrBuilder *Sb, longint n, byte Digits)
+  {
+    return IntToSbBase (Sb, n, Digits, 16);
+  }
+
+int IntToSbDecimals (_StrBuilder *Sb, longint n, byte Decimals)
+  {
+    char *p;
+    //
+    p = StrBuilderReserve (Sb, IntToStrMax + 2);
+    if (p == NULL)
+      return 0;
+    return StrBuilderAdded (Sb, IntToStrDecimals (&p, n, Decimals));
+  }
+
+int IntToSbScaled (_StrBuilder *Sb, longint n)
+  {
+    char *p;
+    //
+    p = StrBuilderReserve (Sb, IntToStrMax + 2);
+    if (p == NULL)
+      return 0;
+    return StrBuilderAdded (Sb, IntToStrScaled (&p, n));
+  }
+
+int RealToSb (_StrBuilder *Sb, double Val, int Decimals, byte Flags)
+  {
+    char *p;
+    //
+    p = NULL;   // Size it first
+    p = StrBuilderReserve (Sb, RealToStr (&p, Val, Decimals, Flags));
+    if (p == NULL)
+      return 0;
+    return StrBuilderAdded (Sb, RealToStr (&p, Val, Decimals, Flags));
+  }
+
+bool DateTimeToSb (_StrBuilder *Sb, time_t DateTime, char *Format)
+  {
+    char *p, *p0;
+    bool Res;
+    //
+    p = p0 = StrBuilderReserve (Sb, 64);
+    if (p == NULL)
+      return false;
+    Res = DateTimeToStrLocalize (&p, DateTime, Format);
+    StrBuilderAdded (Sb, p - p0);
+    return Res;
+  }
+
+int IntStrToSb (_StrBuilder *Sb, longint Num, char *StrSingular, char *StrPlural)
+  {
+    char *p;
+    bool First;
+    //
+    p = NULL;   // Size it first, that changes IntStrToStrFirst so put it back
+    First = IntStrToStrFirst;
+    p = StrBuilderReserve (Sb, IntStrToStr (&p, Num, StrSingular, StrPlural));
+    IntStrToStrFirst = First;
+    if (p == NULL)
+      return 0;
+    return StrBuilderAdded (Sb, IntStrToStr (&p, Num, StrSingular, StrPlural));
+  }
+
+
 /*
 // DataToHex:
 // Convert block of raw data to string of Hex broken by spaces and \n
@@ -1471,90 +3865,66 @@ char *DataToHex (byte *Data, unsigned int DataLen, unsigned int *Size, int Width
 // Always ends on /n
 // Caller must free returned result
 
-char *DataToHex_ (byte *Data, unsigned int DataLen, unsigned int *Size, int Width, bool AllowASCII)   // Caller must free returned result
+char *ArenaDataToHex_ (_Arena *Arena, byte *Data, unsigned int DataLen, unsigned int *Size, int Width, bool AllowASCII)
   {
     char *Res, *r;
     unsigned int Line, Break, i;
     byte d;
     bool ASCII, ASCII_;
     //
-    Res = NULL;
-    while (true)
+    // Most per byte is 5: '" ' leaving ASCII then "xx ". Plus '"', lf & 0 at the end
+    r = Res = (char *) LibAlloc (Arena, DataLen * 5 + 3);
+    Line = 0;
+    Break = 0;
+    ASCII = ASCII_ = false;
+    i = 0;
+    while (i < DataLen)
       {
-        *Size = 0;
-        r = Res;
-        Line = 0;
-        Break = 0;
-        ASCII = ASCII_ = false;
-        i = 0;
-        while (i < DataLen)
+        d = Data [i];   // Next data byte
+        if (AllowASCII)
+          ASCII_ = (d >= ' ') && (d < 0x7F) && (d != '\"');   // Is data displayable as ASCII character?
+        if (ASCII_ && !ASCII)   // Go to "ASCII" mode?
+          *r++ = '\"';
+        else if (!ASCII_ && ASCII)   // Go to HEX mode?
           {
-            d = Data [i];   // Next data byte
-            if (AllowASCII)
-              ASCII_ = (d >= ' ') && (d < 0x7F) && (d != '\"');   // Is data displayable as ASCII character?
-            if (ASCII_ && !ASCII)   // Go to "ASCII" mode?
-              {
-                (*Size)++;
-                if (Res)
-                  *r++ = '\"';
-              }
-            else if (!ASCII_ && ASCII)   // Go to HEX mode?
-              {
-                (*Size) += 2;
-                if (Res)
-                  StrToStr (&r, "\" ");
-                Break = *Size - 1;
-              }
-            else if (ASCII)   // Add data as ASCII
-              {
-                (*Size)++;
-                if (Res)
-                  *r++ = d;
-                i++;
-              }
-            else   // Otherwise show as HEX
-              {
-                (*Size) += 3;
-                if (Res)
-                  {
-                    IntToHex (&r, d, 2 | IntToLengthZeros);
-                    *r++ = ' ';
-                  }
-                i++;
-                Break = *Size - 1;
-              }
-            ASCII = ASCII_;
-            if (Width)
-              if (((int) (*Size - Line) + 1 >= Width) && (Break > Line))   // Line full and breakable
-                {
-                  if (Res)
-                    Res [Break] = lf;
-                  Line = Break + 1;
-                }
+            StrToStr (&r, "\" ");
+            Break = r - Res - 1;
           }
-        // End ASCII?
-        if (ASCII)
+        else if (ASCII)   // Add data as ASCII
           {
-            (*Size)++;
-            if (Res)
-              *r++ = '\"';
+            *r++ = d;
+            i++;
           }
-        // End line (if needed)
-        if (Line != *Size)
+        else   // Otherwise show as HEX
           {
-            (*Size)++;
-            if (Res)
-              *r++ = lf;
+            IntToHex (&r, d, 2 | IntToLengthZeros);
+            *r++ = ' ';
+            i++;
+            Break = r - Res - 1;
           }
-        // Terminate
-        if (Res)
-          *r = 0;
-        // Allocate storage
-        if (Res == NULL)
-          Res = (char *) malloc (*Size + 1);   // Size includes trailing lf but not terminating 0
-        else
-          return Res;
+        ASCII = ASCII_;
+        if (Width)
+          if (((int) (r - Res - Line) + 1 >= Width) && (Break > Line))   // Line full and breakable
+            {
+              Res [Break] = lf;
+              Line = Break + 1;
+            }
       }
+    // End ASCII?
+    if (ASCII)
+      *r++ = '\"';
+    // End line (if needed)
+    if (Line != (unsigned int) (r - Res))
+      *r++ = lf;
+    // Terminate
+    *r = 0;
+    *Size = r - Res;   // Size includes trailing lf but not terminating 0
+    return (char *) LibRealloc (Arena, Res, DataLen * 5 + 3, *Size + 1);
+  }
+
+char *DataToHex_ (byte *Data, unsigned int DataLen, unsigned int *Size, int Width, bool AllowASCII)   // Caller must free returned result
+  {
+    return ArenaDataToHex_ (NULL, Data, DataLen, Size, Width, AllowASCII);
   }
 
 char *DataToHex (byte *Data, unsigned int DataLen, unsigned int *Size, int Width)
@@ -1567,98 +3937,202 @@ char *DataToHexAscii (byte *Data, unsigned int DataLen, unsigned int *Size, int
     return DataToHex_ (Data, DataLen, Size, Width, true);
   }
 
+char *ArenaDataToHex (_Arena *Arena, byte *Data, unsigned int DataLen, unsigned int *Size, int Width)
+  {
+    return ArenaDataToHex_ (Arena, Data, DataLen, Size, Width, false);
+  }
+
+char *ArenaDataToHexAscii (_Arena *Arena, byte *Data, unsigned int DataLen, unsigned int *Size, int Width)
+  {
+    return ArenaDataToHex_ (Arena, Data, DataLen, Size, Width, true);
+  }
+
 
 // StrIndent: Replace dynamic string with indented version: \n -> \n {space}
 void StrIndent (char **St, int Indent)
   {
-    char *Res, c;
-    int i, j, k;
+    char *Res, *r, *s, *e;
+    int Lines;
     //
-    Res = NULL;
-    i = 0;
-    j = 0;
+    // Every \n gets Indent, except one at the very end
+    Lines = StrChCount (*St, '\n', 0);
+    if (Lines && *(StrEnd (*St) - 1) == '\n')
+      Lines--;
+    r = Res = (char *) malloc (StrLength (*St) + Lines * Indent + 1);
+    s = *St;
     while (true)
       {
-        c = (*St) [i];
-        if (Res)
-          Res [j] = c;
-        i++;
-        j++;
-        if (c == 0)
-          if (Res)
-            break;
-          else
-            {
-              Res = (char *) malloc (j);
-              i = 0;
-              j = 0;
-            }
-        else
-          if ((c == '\n') && (*St) [i])
-            for (k = 0; k < Indent; k++)
-              {
-                if (Res)
-                  Res [j] = ' ';
-                j++;
-              }
+        e = StrPosCh_ (s, '\n');
+        if (e == NULL || e [1] == 0)
+          break;
+        e++;
+        MemMove (r, s, e - s);
+        r += e - s;
+        MemSet (r, ' ', Indent);
+        r += Indent;
+        s = e;
       }
+    StrCopy (r, s);
     free (*St);
     *St = Res;
   }
 
-// Replace Target with Replacement in new string, returned
+#define StrReplaceInline 64   // Matches held on the stack, more go to the heap
+
+// Non overlapping matches of Target (SizeTarget long) in St, Count of them in *Pos
+// *Pos is Inline unless there are more than StrReplaceInline, then caller must free it
+unsigned int StrReplaceFind (char *St, unsigned int SizeSt, char *Target, unsigned int SizeTarget, _StrPosMode StrPosMode, unsigned int *Inline, unsigned int **Pos)
+  {
+    _StrWild Wild;
+    bool Compiled;
+    unsigned int Count, Allocated, a, b;
+    //
+    *Pos = Inline;
+    Count = 0;
+    if (SizeTarget == 0)
+      return 0;
+    Allocated = StrReplaceInline;
+    Compiled = StrPosMode == spmWild && StrWildCompile (&Wild, Target);
+    a = 0;
+    while (a < SizeSt)
+      {
+        b = Compiled ? StrWildPosFrom (&Wild, St, a) : StrPosFrom (St, a, Target, StrPosMode);
+        if ((int) b == -1 || b >= SizeSt)   // not found
+          break;
+        if (Count == Allocated)
+          {
+            Allocated *= 2;
+            if (*Pos == Inline)
+              {
+                *Pos = (unsigned int *) malloc (sizeof (unsigned int) * Allocated);
+                MemMove (*Pos, Inline, sizeof (unsigned int) * Count);
+              }
+            else
+              *Pos = (unsigned int *) realloc (*Pos, sizeof (unsigned int) * Allocated);
+          }
+        (*Pos) [Count++] = b;
+        a = b + SizeTarget;
+      }
+    return Count;
+  }
+
+// Replace Target with Replacement in new string, returned (from Arena if not NULL)
 // Size is returned. Result will be 0 terminated
 // Returns NULL if Target not found
-char *StrReplaceAll_ (char *St, char *Target, char *Replacement, unsigned int *Size, _StrPosMode StrPosMode)
+char *ArenaStrReplaceAll (_Arena *Arena, char *St, char *Target, char *Replacement, unsigned int *Size, _StrPosMode StrPosMode)
   {
-    unsigned int Siz;
-    unsigned int SizeSt, SizeTarget;
+    unsigned int Inline [StrReplaceInline], *Pos;
+    unsigned int SizeSt, SizeTarget, SizeReplacement;
+    unsigned int Count, Siz, a, i;
     char *Res, *r;
-    unsigned int a, b;
-    bool Changed;
     //
-    Changed = false;
     SizeSt = StrLength (St);
     SizeTarget = StrLength (Target);
-    Siz = a = 0;
-    r = Res = NULL;
-    while (true)
+    SizeReplacement = StrLength (Replacement);
+    Count = StrReplaceFind (St, SizeSt, Target, SizeTarget, StrPosMode, Inline, &Pos);
+    if (Count == 0)
+      return NULL;
+    // Exact size: a wild match at the end may take in the 0
+    Siz = Count * SizeReplacement;
+    a = 0;
+    for (i = 0; i < Count; i++)
       {
-        b = StrPosFrom (St, a, Target, StrPosMode);
-        if ((int) b == -1)   // not found
-          b = SizeSt;
-        Siz += StrToStrN (&r, St + a, b - a);
-        if (b < SizeSt)
+        Siz += Pos [i] - a;
+        a = Pos [i] + SizeTarget;
+      }
+    if (a < SizeSt)
+      Siz += SizeSt - a;
+    // Copy the spans between matches
+    r = Res = (char *) LibAlloc (Arena, Siz + 1);
+    a = 0;
+    for (i = 0; i < Count; i++)
+      {
+        MemMove (r, St + a, Pos [i] - a);
+        r += Pos [i] - a;
+        MemMove (r, Replacement, SizeReplacement);
+        r += SizeReplacement;
+        a = Pos [i] + SizeTarget;
+      }
+    if (a < SizeSt)
+      {
+        MemMove (r, St + a, SizeSt - a);
+        r += SizeSt - a;
+      }
+    *r = 0;
+    if (Pos != Inline)
+      free (Pos);
+    if (Size)
+      *Size = Siz;
+    return Res;
+  }
+
+char *StrReplaceAll_ (char *St, char *Target, char *Replacement, unsigned int *Size, _StrPosMode StrPosMode)
+  {
+    return ArenaStrReplaceAll (NULL, St, Target, Replacement, Size, StrPosMode);
+  }
+
+// As above but in St itself, if Replacement is no longer than Target
+// Returns the number replaced, -1 if Replacement is too long (St unchanged)
+int StrReplaceAllInPlace (char *St, char *Target, char *Replacement, unsigned int *Size, _StrPosMode StrPosMode)
+  {
+    _StrWild Wild;
+    bool Compiled;
+    unsigned int SizeSt, SizeTarget, SizeReplacement, a, b;
+    char *w;
+    int Count;
+    //
+    SizeTarget = StrLength (Target);
+    SizeReplacement = StrLength (Replacement);
+    if (SizeReplacement > SizeTarget)
+      return -1;
+    SizeSt = StrLength (St);
+    Count = 0;
+    if (SizeTarget)
+      {
+        Compiled = StrPosMode == spmWild && StrWildCompile (&Wild, Target);
+        if (StrPosMode == spmWild)   // A match taking in the 0 may leave no room
+          for (b = SizeSt > SizeTarget ? SizeSt - SizeTarget + 1 : 0; b < SizeSt; b++)
+            if (Compiled ? StrWildMatch (&Wild, St + b) : StrMatch (St + b, Target, 0, spmWild))
+              return -1;
+        w = St;   // Writing never passes reading, which is always after the last match
+        a = 0;
+        while (a < SizeSt)
           {
-            Siz += StrToStr (&r, Replacement);
-            Changed = true;
+            b = Compiled ? StrWildPosFrom (&Wild, St, a) : StrPosFrom (St, a, Target, StrPosMode);
+            if ((int) b == -1 || b >= SizeSt)   // not found
+              break;
+            MemMove (w, St + a, b - a);
+            w += b - a;
+            MemMove (w, Replacement, SizeReplacement);
+            w += SizeReplacement;
+            a = b + SizeTarget;
+            Count++;
           }
-        a = b + SizeTarget;
-        if (a >= SizeSt)   // end reached
+        if (Count)
           {
-            if (Res)
+            if (a < SizeSt)
               {
-                *r = 0;
-                if (Size)
-                  *Size = Siz;
-                return Res;
+                MemMove (w, St + a, SizeSt - a);
+                w += SizeSt - a;
               }
-            if (Changed)
-              {
-                r = Res = (char *) malloc (Siz + 1);
-                Siz = a = 0;
-              }
-            else
-              return NULL;
+            *w = 0;
+            SizeSt = w - St;
           }
       }
+    if (Size)
+      *Size = SizeSt;
+    return Count;
   }
 
 // As above but replaces dynamic string St
 bool StrReplaceAll (char **St, char *Target, char *Replacement, unsigned int *Size, _StrPosMode StrPosMode)
   {
     char *Res;
+    int Count;
     //
+    Count = StrReplaceAllInPlace (*St, Target, Replacement, Size, StrPosMode);
+    if (Count >= 0)   // Fitted in St
+      return Count > 0;
     Res = StrReplaceAll_ (*St, Target, Replacement, Size, StrPosMode);
     if (Res)
       {
@@ -1774,10 +4248,8 @@ typedef struct
 bool ArrayCheckSize (_Array *Array, int Size)
   {
     int s;
-    void *d;
-    bool Res;
+    void **d;
     //
-    Res = true;
     if (Size > Array->SizeAllocated)
       {
         s = Array->SizeAllocated;
@@ -1786,20 +4258,14 @@ bool ArrayCheckSize (_Array *Array, int Size)
             s = 1;
           else
             s = s << 1;
-        d = malloc (sizeof (void *) * s);
-        if (d)
-          {
-            MemSet (d, 0, sizeof (void *) * s);
-            MemMove (d, Array->Data, sizeof (void *) * Array->SizeAllocated);
-            free (Array->Data);
-            //memmove (Array->Data, d, sizeof (d));
-            Array->Data = (void **) d;
-            Array->SizeAllocated = s;
-          }
-        else
-          Res = false;
+        d = (void **) realloc (Array->Data, sizeof (void *) * s);
+        if (d == NULL)
+          return false;
+        MemSet (d + Array->SizeAllocated, 0, sizeof (void *) * (s - Array->SizeAllocated));   // Only the new part
+        Array->Data = d;
+        Array->SizeAllocated = s;
       }
-    return Res;
+    return true;
   }
 
 typedef void _ArrayFreeElement (void *Data);
@@ -1808,7 +4274,7 @@ void ArrayFree (_Array *Array, _ArrayFreeElement *ArrayFreeElement)
   {
     int i;
     //
-    for (i = 0; i < Array->SizeAllocated; i++)
+    for (i = 0; i < Array->Size; i++)   // Nothing is set past Size
       if (Array->Data [i])
         {
           if (ArrayFreeElement)
@@ -1825,7 +4291,8 @@ bool ArraySet (_Array *Array, int Index, void *Data)
   {
     if (ArrayCheckSize (Array, Index + 1))
       {
-        free (Array->Data [Index]);
+        if (Index < Array->Size)   // Past Size is still NULL
+          free (Array->Data [Index]);
         Array->Data [Index] = Data;
         if (Index >= Array->Size)
           Array->Size = Index + 1;
@@ -1847,19 +4314,184 @@ bool ArrayAdd (_Array *Array, void *Data)
   }
 
 
+////////////////////////////////////////////////////////////////////////////
+//
+// TYPED DYNAMIC ARRAYS
+//   ArrayOf (Name, Type) declares _Name holding Type elements in one block
+//   (Data [0 .. Size - 1]) grown by realloc, and these functions:
+//     NameInit, NameFree, NameClear
+//     NameReserve (at least n allocated), NameResize (new elements zeroed), NameShrink
+//     NameAdd, NameAddN (bulk), NameAppend (n uninitialised elements at the end)
+//     NameInsert, NameDelete (keep order)
+//   Elements are moved with MemMove so must not point into themselves.
+
+#define ArrayOf(Name, Type) \
+  typedef struct \
+    { \
+      Type *Data; \
+      int Size; \
+      int SizeAllocated; \
+    } _##Name; \
+  \
+  void Name##Init (_##Name *Array) \
+    { \
+      Array->Data = NULL; \
+      Array->Size = 0; \
+      Array->SizeAllocated = 0; \
+    } \
+  \
+  void Name##Free (_##Name *Array) \
+    { \
+      free (Array->Data); \
+      Name##Init (Array); \
+    } \
+  \
+  void Name##Clear (_##Name *Array)   /* Keeps the memory */ \
+    { \
+      Array->Size = 0; \
+    } \
+  \
+  bool Name##Reserve (_##Name *Array, int Size) \
+    { \
+      Type *d; \
+      int s; \
+      if (Size <= Array->SizeAllocated) \
+        return true; \
+      if (Size < 0)   /* Size + n overflowed */ \
+        return false; \
+      s = Array->SizeAllocated ? Array->SizeAllocated : 4; \
+      while (s < Size) \
+        if (s >= 0x40000000)   /* Doubling would overflow int */ \
+          s = Size; \
+        else \
+          s = s << 1; \
+      d = (Type *) realloc (Array->Data, sizeof (Type) * s); \
+      if (d == NULL) \
+        return false; \
+      Array->Data = d; \
+      Array->SizeAllocated = s; \
+      return true; \
+    } \
+  \
+  bool Name##Resize (_##Name *Array, int Size) \
+    { \
+      if (!Name##Reserve (Array, Size)) \
+        return false; \
+      if (Size > Array->Size) \
+        MemSet (Array->Data + Array->Size, 0, sizeof (Type) * (Size - Array->Size)); \
+      Array->Size = Size; \
+      return true; \
+    } \
+  \
+  void Name##Shrink (_##Name *Array)   /* Release what's not in use */ \
+    { \
+      Type *d; \
+      if (Array->Size == 0) \
+        Name##Free (Array); \
+      else if (Array->Size < Array->SizeAllocated) \
+        { \
+          d = (Type *) realloc (Array->Data, sizeof (Type) * Array->Size); \
+          if (d) \
+            { \
+              Array->Data = d; \
+              Array->SizeAllocated = Array->Size; \
+            } \
+        } \
+    } \
+  \
+  Type *Name##Append (_##Name *Array, int n)   /* NULL if out of memory */ \
+    { \
+      if (!Name##Reserve (Array, Array->Size + n)) \
+        return NULL; \
+      Array->Size += n; \
+      return Array->Data + Array->Size - n; \
+    } \
+  \
+  bool Name##Add (_##Name *Array, Type Value) \
+    { \
+      if (Array->Size == Array->SizeAllocated && !Name##Reserve (Array, Array->Size + 1)) \
+        return false; \
+      Array->Data [Array->Size++] = Value; \
+      return true; \
+    } \
+  \
+  bool Name##AddN (_##Name *Array, const Type *Values, int n)   /* Values may be in Array */ \
+    { \
+      Type *d; \
+      int Offset; \
+      Offset = -1; \
+      if (Values >= Array->Data && Values < Array->Data + Array->Size) \
+        Offset = Values - Array->Data;   /* Append may move it */ \
+      d = Name##Append (Array, n); \
+      if (d == NULL) \
+        return false; \
+      if (Offset >= 0) \
+        Values = Array->Data + Offset; \
+      MemMove (d, (void *) Values, sizeof (Type) * n); \
+      return true; \
+    } \
+  \
+  bool Name##Insert (_##Name *Array, int Index, Type Value) \
+    { \
+      if (Index < 0 || Index > Array->Size || !Name##Reserve (Array, Array->Size + 1)) \
+        return false; \
+      MemMove (Array->Data + Index + 1, Array->Data + Index, sizeof (Type) * (Array->Size - Index)); \
+      Array->Data [Index] = Value; \
+      Array->Size++; \
+      return true; \
+    } \
+  \
+  void Name##Delete (_##Name *Array, int Index) \
+    { \
+      if (Index >= 0 && Index < Array->Size) \
+        { \
+          Array->Size--; \
+          MemMove (Array->Data + Index, Array->Data + Index + 1, sizeof (Type) * (Array->Size - Index)); \
+        } \
+    }
+
+ArrayOf (IntArray, int)
+
+
 ////////////////////////////////////////////////////////////////////////////
 //
 // STRING ARRAY SUPPORT
 //
 
-int StrCompareCase (char *S1, char *S2, bool Cased)
+LibNoSanitize int StrCompareCase (char *S1, char *S2, bool Cased)
   {
     int delta;
+    #ifdef LibFast
+    _LibChunk a, b;
+    _LibMask m;
+    #endif
     //
     if (!S1)
       S1 = (char *) StrNull;
     if (!S2)
       S2 = (char *) StrNull;
+    #ifdef LibFast
+    // Skip the equal part a chunk at a time, the bytes below sort out the first difference or 0
+    while (LibPageSafe (S1) && LibPageSafe (S2))
+      {
+        a = LibLoadU (S1);
+        b = LibLoadU (S2);
+        if (!Cased)
+          {
+            a = LibUpCase (a);
+            b = LibUpCase (b);
+          }
+        m = LibMaskEq (a, LibSplat (0)) | (~LibMaskEq (a, b) & LibMaskAll);
+        if (m)
+          {
+            S1 += LibMaskIndex (m);
+            S2 += LibMaskIndex (m);
+            break;
+          }
+        S1 += LibChunkSize;
+        S2 += LibChunkSize;
+      }
+    #endif
     while (true)
       {
         if (*S1 == 0 && *S2 == 0)
@@ -1891,11 +4523,7 @@ void StringArrayPromote (char **StringArray, int Size, int n)
     if (n && (n < Size))
       {
         SAn = StringArray [n];
-        while (n)
-          {
-            StringArray [n] = StringArray [n - 1];
-            n--;
-          }
+        MemMove (StringArray + 1, StringArray, sizeof (char *) * n);
         StringArray [0] = SAn;
       }
   }
@@ -2017,51 +4645,706 @@ void StringArrayFree (char **StringArray, int Size)
         }
   }
 
-int StringArraySearch (char **StringArray, int Size, char *Key)
+int StringArraySearch (char **StringArray, int Size, char *Key)
+  {
+    int Res;
+    char *p;
+    int i;
+    //
+    Res = 0;
+    while (true)
+      {
+        if (Res >= Size)   // Not found
+          return -1;
+        p = StringArray [Res];
+        if (p == NULL)
+          return -1;
+        i = 0;
+        while (true)
+          {
+            if (Key [i] < ' ')   // Found: Allow for tab/cr/lf/null separation
+              return Res;
+            if (Key [i] != p [i])
+              break;
+            i++;
+          }
+        Res++;
+      }
+  }
+
+void StringArraySearchReplace (char **StringArray, int Size, char *KeyData)
+  {
+    int Index;
+    //
+    Index = StringArraySearch (StringArray, Size, KeyData);
+    if (Index >= 0)   // Found
+      StrAssign (&StringArray [Index], KeyData);
+    else
+      StringArrayAdd (StringArray, Size, KeyData);
+  }
+
+void StringArraySearchRemove (char **StringArray, int Size, char *Key)
+  {
+    int Index;
+    //
+    Index = StringArraySearch (StringArray, Size, Key);
+    if (Index >= 0)   // Found
+      StringArrayDelete (StringArray, Size, Index);
+  }
+
+
+////////////////////////////////////////////////////////////////////////////
+//
+// HASHING
+//
+// HashData64: Fast non-cryptographic 64 bit hash (XXH64)
+// Chain blocks of a stream by passing the last result as Seed
+
+#define HashPrime1 11400714785074694791ULL
+#define HashPrime2 14029467366897019727ULL
+#define HashPrime3 1609587929392839161ULL
+#define HashPrime4 9650029242287828579ULL
+#define HashPrime5 2870177450012600261ULL
+
+#define HashRotate(X,N) (((X) << (N)) | ((X) >> (64 - (N))))
+
+unsigned long long HashRound (unsigned long long Acc, unsigned long long Input)
+  {
+    Acc += Input * HashPrime2;
+    Acc = HashRotate (Acc, 31);
+    return Acc * HashPrime1;
+  }
+
+unsigned long long HashMerge (unsigned long long Acc, unsigned long long Val)
+  {
+    Acc ^= HashRound (0, Val);
+    return Acc * HashPrime1 + HashPrime4;
+  }
+
+unsigned long long HashRead64 (byte *p)
+  {
+    unsigned long long Res;
+    //
+    MemMove (&Res, p, sizeof (Res));
+    return Res;
+  }
+
+unsigned long long HashData64 (void *Data, unsigned int Size, unsigned long long Seed)
+  {
+    byte *p, *End;
+    unsigned long long v1, v2, v3, v4, h;
+    unsigned int k;
+    //
+    p = (byte *) Data;
+    End = p + Size;
+    if (Size >= 32)
+      {
+        v1 = Seed + HashPrime1 + HashPrime2;
+        v2 = Seed + HashPrime2;
+        v3 = Seed;
+        v4 = Seed - HashPrime1;
+        while (p + 32 <= End)
+          {
+            v1 = HashRound (v1, HashRead64 (p));
+            v2 = HashRound (v2, HashRead64 (p + 8));
+            v3 = HashRound (v3, HashRead64 (p + 16));
+            v4 = HashRound (v4, HashRead64 (p + 24));
+            p += 32;
+          }
+        h = HashRotate (v1, 1) + HashRotate (v2, 7) + HashRotate (v3, 12) + HashRotate (v4, 18);
+        h = HashMerge (h, v1);
+        h = HashMerge (h, v2);
+        h = HashMerge (h, v3);
+        h = HashMerge (h, v4);
+      }
+    else
+      h = Seed + HashPrime5;
+    h += Size;
+    while (p + 8 <= End)
+      {
+        h ^= HashRound (0, HashRead64 (p));
+        h = HashRotate (h, 27) * HashPrime1 + HashPrime4;
+        p += 8;
+      }
+    if (p + 4 <= End)
+      {
+        k = 0;
+        MemMove (&k, p, 4);
+        h ^= (unsigned long long) k * HashPrime1;
+        h = HashRotate (h, 23) * HashPrime2 + HashPrime3;
+        p += 4;
+      }
+    while (p < End)
+      {
+        h ^= *p++ * HashPrime5;
+        h = HashRotate (h, 11) * HashPrime1;
+      }
+    // Avalanche
+    h ^= h >> 33;
+    h *= HashPrime2;
+    h ^= h >> 29;
+    h *= HashPrime3;
+    h ^= h >> 32;
+    return h;
+  }
+
+
+////////////////////////////////////////////////////////////////////////////
+//
+// HASH TABLES
+//
+// _HashMap: string or integer keys to void * values, open addressing (Swiss table).
+//   Each slot has a control byte: HashEmpty, HashDeleted, or 7 bits of its key's hash.
+//   A whole group of control bytes is compared at once, so a probe rarely looks at
+//   a slot that doesn't hold the key. String keys are copied into blocks owned by
+//   the map and released together; a resize copies the live ones into fresh blocks,
+//   so like the slots they move. A _HashSet is a map that ignores Value.
+
+#define HashEmpty 0x80
+#define HashDeleted 0xFE
+
+#ifdef LibFast
+  #define HashGroup LibChunkSize
+  typedef _LibMask _HashMask;
+  #define HashMaskIndex(m) LibMaskIndex (m)
+
+  _HashMask HashMatch (byte *Control, byte h)   // Slots in the group at Control with control byte h
+    {
+      return LibMaskEq (LibLoadU (Control), LibSplat (h));
+    }
+#else
+  #define HashGroup 8
+  typedef unsigned int _HashMask;
+
+  int HashMaskIndex (_HashMask m)
+    {
+      int Res;
+      //
+      Res = 0;
+      while (!(m & 1))
+        {
+          m >>= 1;
+          Res++;
+        }
+      return Res;
+    }
+
+  _HashMask HashMatch (byte *Control, byte h)
+    {
+      _HashMask m;
+      int i;
+      //
+      m = 0;
+      for (i = 0; i < HashGroup; i++)
+        if (Control [i] == h)
+          m |= 1 << i;
+      return m;
+    }
+#endif
+
+typedef struct _HashKeys
+  {
+    struct _HashKeys *Next;
+    unsigned int Used;
+    unsigned int Size;   // Bytes of keys following this header
+  } _HashKeys;
+
+typedef struct
+  {
+    union
+      {
+        char *St;
+        unsigned long long Int;
+      } Key;
+    void *Value;
+  } _HashSlot;
+
+typedef struct
+  {
+    byte *Control;   // SlotSize + HashGroup: the first group is repeated at the end
+    _HashSlot *Slot;
+    unsigned int SlotSize;   // Power of 2. 0 until the first add
+    unsigned int Count;
+    unsigned int Deleted;
+    bool StringKeys;
+    _HashKeys *Keys;
+  } _HashMap;
+
+typedef _HashMap _HashSet;
+
+void HashMapInit (_HashMap *Map, bool StringKeys)
+  {
+    MemSet (Map, 0, sizeof (_HashMap));
+    Map->StringKeys = StringKeys;
+  }
+
+void HashKeysFree (_HashKeys *Keys)
+  {
+    _HashKeys *k;
+    //
+    while (Keys)
+      {
+        k = Keys;
+        Keys = k->Next;
+        free (k);
+      }
+  }
+
+void HashMapClear (_HashMap *Map)   // Remove everything but keep the slots
+  {
+    HashKeysFree (Map->Keys);
+    Map->Keys = NULL;
+    if (Map->Control)
+      MemSet (Map->Control, HashEmpty, Map->SlotSize + HashGroup);
+    Map->Count = 0;
+    Map->Deleted = 0;
+  }
+
+void HashMapFree (_HashMap *Map)
+  {
+    HashMapClear (Map);
+    free (Map->Control);
+    free (Map->Slot);
+    HashMapInit (Map, Map->StringKeys);
+  }
+
+unsigned long long HashInt (unsigned long long Key)
+  {
+    Key ^= Key >> 33;
+    Key *= 0xFF51AFD7ED558CCDULL;
+    Key ^= Key >> 33;
+    Key *= 0xC4CEB9FE1A85EC53ULL;
+    return Key ^ (Key >> 33);
+  }
+
+unsigned long long HashStr (char *Key)
+  {
+    return HashData64 (Key, StrLength (Key), 0);
+  }
+
+char *HashKeyCopy (_HashMap *Map, char *Key)   // Into Map's key blocks. NULL if out of memory
+  {
+    _HashKeys *k;
+    char *Res;
+    unsigned int Length, Size;
+    //
+    Length = StrLength (Key) + 1;
+    k = Map->Keys;
+    if (k == NULL || k->Used + Length > k->Size)
+      {
+        Size = k ? (k->Size < 0x100000 ? k->Size * 2 : 0x100000) : 4096;
+        if (Size < Length)
+          Size = Length;
+        k = (_HashKeys *) malloc (sizeof (_HashKeys) + Size);
+        if (k == NULL)
+          return NULL;
+        k->Next = Map->Keys;
+        k->Used = 0;
+        k->Size = Size;
+        Map->Keys = k;
+      }
+    Res = (char *) (k + 1) + k->Used;
+    MemMove (Res, Key, Length);
+    k->Used += Length;
+    return Res;
+  }
+
+void HashMapSetControl (_HashMap *Map, unsigned int i, byte h)
+  {
+    Map->Control [i] = h;
+    if (i < HashGroup)
+      Map->Control [Map->SlotSize + i] = h;
+  }
+
+// Slot index of the key, or -1. St for string keys, Int otherwise
+int HashMapLookup (_HashMap *Map, unsigned long long Hash, char *St, unsigned long long Int)
+  {
+    _HashMask m;
+    unsigned int Pos, Step, Mask, i;
+    byte h;
+    //
+    if (Map->Count == 0)
+      return -1;
+    Mask = Map->SlotSize - 1;
+    h = Hash & 0x7F;
+    Pos = (Hash >> 7) & Mask;
+    Step = 0;
+    while (true)
+      {
+        m = HashMatch (&Map->Control [Pos], h);
+        while (m)
+          {
+            i = (Pos + HashMaskIndex (m)) & Mask;
+            if (Map->StringKeys ? StrCompare (Map->Slot [i].Key.St, St) == 0 : Map->Slot [i].Key.Int == Int)
+              return i;
+            m &= m - 1;
+          }
+        if (HashMatch (&Map->Control [Pos], HashEmpty))   // Would have been put here
+          return -1;
+        Step += HashGroup;
+        Pos = (Pos + Step) & Mask;
+      }
+  }
+
+unsigned int HashMapVacant (_HashMap *Map, unsigned long long Hash)   // First empty or deleted slot for Hash
+  {
+    _HashMask m;
+    unsigned int Pos, Step, Mask;
+    //
+    Mask = Map->SlotSize - 1;
+    Pos = (Hash >> 7) & Mask;
+    Step = 0;
+    while (true)
+      {
+        m = HashMatch (&Map->Control [Pos], HashEmpty) | HashMatch (&Map->Control [Pos], HashDeleted);
+        if (m)
+          return (Pos + HashMaskIndex (m)) & Mask;
+        Step += HashGroup;
+        Pos = (Pos + Step) & Mask;
+      }
+  }
+
+// Also drops the deleted slots, and the copies of removed string keys
+bool HashMapResize (_HashMap *Map, unsigned int SlotSize)
+  {
+    byte *OldControl;
+    _HashSlot *OldSlot;
+    _HashKeys *OldKeys;
+    unsigned long long Hash;
+    unsigned int OldSize, i, j;
+    char *St;
+    //
+    OldControl = Map->Control;
+    OldSlot = Map->Slot;
+    OldSize = Map->SlotSize;
+    OldKeys = Map->Keys;
+    Map->Control = (byte *) malloc (SlotSize + HashGroup);
+    Map->Slot = (_HashSlot *) malloc (sizeof (_HashSlot) * SlotSize);
+    Map->Keys = NULL;
+    if (Map->Control && Map->Slot)
+      {
+        MemSet (Map->Control, HashEmpty, SlotSize + HashGroup);
+        Map->SlotSize = SlotSize;
+        for (i = 0; i < OldSize; i++)
+          if (OldControl [i] < HashEmpty)
+            {
+              Hash = Map->StringKeys ? HashStr (OldSlot [i].Key.St) : HashInt (OldSlot [i].Key.Int);
+              j = HashMapVacant (Map, Hash);
+              HashMapSetControl (Map, j, Hash & 0x7F);
+              Map->Slot [j] = OldSlot [i];
+              if (Map->StringKeys)   // Compact the keys
+                {
+                  St = HashKeyCopy (Map, OldSlot [i].Key.St);
+                  if (St == NULL)
+                    break;
+                  Map->Slot [j].Key.St = St;
+                }
+            }
+        if (i == OldSize)
+          {
+            Map->Deleted = 0;
+            HashKeysFree (OldKeys);
+            free (OldControl);
+            free (OldSlot);
+            return true;
+          }
+      }
+    // Out of memory: back as it was
+    HashKeysFree (Map->Keys);
+    free (Map->Control);
+    free (Map->Slot);
+    Map->Control = OldControl;
+    Map->Slot = OldSlot;
+    Map->SlotSize = OldSize;
+    Map->Keys = OldKeys;
+    return false;
+  }
+
+_HashSlot *HashMapAddKey (_HashMap *Map, unsigned long long Hash, char *St, unsigned long long Int, bool *Added)
+  {
+    unsigned int Size;
+    int i;
+    char *Copy;
+    //
+    if (Added)
+      *Added = false;
+    i = HashMapLookup (Map, Hash, St, Int);
+    if (i >= 0)
+      return &Map->Slot [i];
+    if ((Map->Count + Map->Deleted + 1) * 8 > Map->SlotSize * 7)   // Keep 1/8 empty so probes end
+      {
+        Size = Map->SlotSize ? Map->SlotSize : 16;
+        while ((Map->Count + 1) * 16 > Size * 7)   // Under half full after
+          Size *= 2;
+        if (!HashMapResize (Map, Size))
+          return NULL;
+      }
+    Copy = NULL;
+    if (Map->StringKeys)
+      {
+        Copy = HashKeyCopy (Map, St);
+        if (Copy == NULL)
+          return NULL;
+      }
+    i = HashMapVacant (Map, Hash);
+    if (Map->Control [i] == HashDeleted)
+      Map->Deleted--;
+    HashMapSetControl (Map, i, Hash & 0x7F);
+    if (Map->StringKeys)
+      Map->Slot [i].Key.St = Copy;
+    else
+      Map->Slot [i].Key.Int = Int;
+    Map->Slot [i].Value = NULL;
+    Map->Count++;
+    if (Added)
+      *Added = true;
+    return &Map->Slot [i];
+  }
+
+bool HashMapRemoveAt (_HashMap *Map, int i)   // The key's copy stays until the next resize
+  {
+    if (i < 0)
+      return false;
+    HashMapSetControl (Map, i, HashDeleted);
+    Map->Count--;
+    Map->Deleted++;
+    return true;
+  }
+
+_HashSlot *HashMapFindStr (_HashMap *Map, char *Key)   // NULL if not there
+  {
+    int i;
+    //
+    i = HashMapLookup (Map, HashStr (Key), Key, 0);
+    return i < 0 ? NULL : &Map->Slot [i];
+  }
+
+_HashSlot *HashMapFindInt (_HashMap *Map, unsigned long long Key)
+  {
+    int i;
+    //
+    i = HashMapLookup (Map, HashInt (Key), NULL, Key);
+    return i < 0 ? NULL : &Map->Slot [i];
+  }
+
+// The key's slot, added with a NULL Value if new (*Added true). NULL if out of memory
+_HashSlot *HashMapAddStr (_HashMap *Map, char *Key, bool *Added)
+  {
+    return HashMapAddKey (Map, HashStr (Key), Key, 0, Added);
+  }
+
+_HashSlot *HashMapAddInt (_HashMap *Map, unsigned long long Key, bool *Added)
+  {
+    return HashMapAddKey (Map, HashInt (Key), NULL, Key, Added);
+  }
+
+bool HashMapRemoveStr (_HashMap *Map, char *Key)   // false if not there
+  {
+    return HashMapRemoveAt (Map, HashMapLookup (Map, HashStr (Key), Key, 0));
+  }
+
+bool HashMapRemoveInt (_HashMap *Map, unsigned long long Key)
+  {
+    return HashMapRemoveAt (Map, HashMapLookup (Map, HashInt (Key), NULL, Key));
+  }
+
+// Every slot in use, in no particular order. Start with *Index 0. NULL after the last
+_HashSlot *HashMapNext (_HashMap *Map, unsigned int *Index)
+  {
+    while (*Index < Map->SlotSize)
+      if (Map->Control [(*Index)++] < HashEmpty)
+        return &Map->Slot [*Index - 1];
+    return NULL;
+  }
+
+bool HashSetAddStr (_HashSet *Set, char *Key)   // false if already there
+  {
+    bool Added;
+    //
+    HashMapAddStr (Set, Key, &Added);
+    return Added;
+  }
+
+bool HashSetAddInt (_HashSet *Set, unsigned long long Key)
+  {
+    bool Added;
+    //
+    HashMapAddInt (Set, Key, &Added);
+    return Added;
+  }
+
+
+////////////////////////////////////////////////////////////////////////////
+//
+// STRING ARRAY INDEX
+//
+// _StringIndex: StringArraySearch, StringArraySearchReplace and StringArraySearchRemove
+//   in constant time, on "key<tab>data" entries of a StringArray. Index maps the key
+//   of each entry (up to its first control character) to a stamp: its position is
+//   stamp - Base, so adding at the top only moves Base. The array keeps the layout the
+//   StringArray functions give it, but must only be changed through these while indexed.
+//   Keys match whole, where StringArraySearch also takes a key that starts an entry's.
+
+typedef struct
+  {
+    char **StringArray;
+    int Size;
+    int Count;   // Entries before the first NULL
+    _HashMap Index;   // Key to stamp
+    longint Base;
+    int Removed;   // Keys gone since the index was built, their copies are kept till then
+    bool Duplicates;   // A key is in more than one entry, the first is indexed
+  } _StringIndex;
+
+// The slot for the key part of St, added if Add (*Added true if new). NULL if not there
+_HashSlot *StringIndexSlot (_StringIndex *Table, char *St, bool Add, bool *Added)
+  {
+    _HashSlot *Res;
+    char Buffer [256];
+    char *Key;
+    unsigned int Length;
+    //
+    Length = 0;
+    while (St [Length] >= ' ')
+      Length++;
+    Key = St;
+    if (St [Length])   // Key followed by data: copy it out to end it
+      {
+        Key = Buffer;
+        if (Length >= sizeof (Buffer))
+          Key = (char *) malloc (Length + 1);
+        if (Key == NULL)
+          return NULL;
+        MemMove (Key, St, Length);
+        Key [Length] = 0;
+      }
+    if (Add)
+      Res = HashMapAddStr (&Table->Index, Key, Added);
+    else
+      Res = HashMapFindStr (&Table->Index, Key);
+    if (Key != St && Key != Buffer)
+      free (Key);
+    return Res;
+  }
+
+void StringIndexBuild (_StringIndex *Table)   // Index the array as it is
+  {
+    _HashSlot *s;
+    bool Added;
+    //
+    HashMapClear (&Table->Index);
+    Table->Base = 0;
+    Table->Removed = 0;
+    Table->Duplicates = false;
+    for (Table->Count = 0; Table->Count < Table->Size && Table->StringArray [Table->Count]; Table->Count++)
+      {
+        s = StringIndexSlot (Table, Table->StringArray [Table->Count], true, &Added);
+        if (s && Added)
+          s->Value = (void *) (longint) Table->Count;
+        else if (s)
+          Table->Duplicates = true;
+      }
+  }
+
+void StringIndexInit (_StringIndex *Table, char **StringArray, int Size)
+  {
+    Table->StringArray = StringArray;
+    Table->Size = Size;
+    HashMapInit (&Table->Index, true);
+    StringIndexBuild (Table);
+  }
+
+void StringIndexFree (_StringIndex *Table)   // The array stays with its owner
+  {
+    HashMapFree (&Table->Index);
+  }
+
+int StringIndexSearch (_StringIndex *Table, char *Key)   // As StringArraySearch
   {
-    int Res;
-    char *p;
-    int i;
+    _HashSlot *s;
     //
-    Res = 0;
-    while (true)
+    s = StringIndexSlot (Table, Key, false, NULL);
+    if (s == NULL)
+      return -1;
+    return (longint) s->Value - Table->Base;
+  }
+
+void StringIndexDrop (_StringIndex *Table, int Index)   // Entry Index's key leaves the index
+  {
+    _HashSlot *s;
+    //
+    s = StringIndexSlot (Table, Table->StringArray [Index], false, NULL);
+    if (s && (longint) s->Value - Table->Base == Index)
       {
-        if (Res >= Size)   // Not found
-          return -1;
-        p = StringArray [Res];
-        if (p == NULL)
-          return -1;
-        i = 0;
-        while (true)
-          {
-            if (Key [i] < ' ')   // Found: Allow for tab/cr/lf/null separation
-              return Res;
-            if (Key [i] != p [i])
-              break;
-            i++;
-          }
-        Res++;
+        HashMapRemoveAt (&Table->Index, s - Table->Index.Slot);
+        Table->Removed++;
       }
   }
 
-void StringArraySearchReplace (char **StringArray, int Size, char *KeyData)
+void StringIndexTidy (_StringIndex *Table)   // Rebuild once the kept key copies outweigh the live ones
+  {
+    if (Table->Removed > Table->Count + 64)
+      StringIndexBuild (Table);
+  }
+
+void StringIndexReplace (_StringIndex *Table, char *KeyData)   // As StringArraySearchReplace
   {
+    _HashSlot *s;
     int Index;
     //
-    Index = StringArraySearch (StringArray, Size, KeyData);
+    Index = StringIndexSearch (Table, KeyData);
     if (Index >= 0)   // Found
-      StrAssign (&StringArray [Index], KeyData);
-    else
-      StringArrayAdd (StringArray, Size, KeyData);
+      {
+        StrAssign (&Table->StringArray [Index], KeyData);
+        return;
+      }
+    if (Table->Size <= 0)
+      return;
+    if (Table->Count >= Table->Size)   // No room: the last entry goes
+      {
+        StringIndexDrop (Table, Table->Size - 1);
+        StrAssign (&Table->StringArray [Table->Size - 1], NULL);
+        Table->Count--;
+      }
+    MemMove (Table->StringArray + 1, Table->StringArray, sizeof (char *) * Table->Count);   // New entry at the top
+    Table->StringArray [0] = NULL;
+    StrAssign (&Table->StringArray [0], KeyData);
+    Table->Count++;
+    Table->Base--;
+    s = StringIndexSlot (Table, KeyData, true, NULL);
+    if (s)
+      s->Value = (void *) Table->Base;
+    StringIndexTidy (Table);
   }
 
-void StringArraySearchRemove (char **StringArray, int Size, char *Key)
+void StringIndexRemove (_StringIndex *Table, char *Key)   // As StringArraySearchRemove
   {
+    _HashSlot *s;
     int Index;
     //
-    Index = StringArraySearch (StringArray, Size, Key);
+    Index = StringIndexSearch (Table, Key);
     if (Index >= 0)   // Found
-      StringArrayDelete (StringArray, Size, Index);
+      {
+        StringIndexDrop (Table, Index);
+        StringArrayDelete (Table->StringArray, Table->Size, Index);
+        Table->Count--;
+        if (Table->Duplicates)   // The next entry with the key takes over
+          StringIndexBuild (Table);
+        else
+          {
+            for (; Index < Table->Count; Index++)   // Those below moved up one
+              {
+                s = StringIndexSlot (Table, Table->StringArray [Index], false, NULL);
+                if (s == NULL)   // Not indexed (out of memory): index afresh
+                  {
+                    StringIndexBuild (Table);
+                    return;
+                  }
+                s->Value = (void *) (Table->Base + Index);
+              }
+            StringIndexTidy (Table);
+          }
+      }
   }
 
 
@@ -2073,85 +5356,205 @@ void StringArraySearchRemove (char **StringArray, int Size, char *Key)
 ////////////////////////////////////////////////////////////////////////////
 //
 // Sort ANY List of struct. First item is a pointer to the next. NULL to terminate.
-// Uses Merge sort with no memory overhead (other than small stack use)
+// Uses a natural merge sort: the list is walked once, splitting it into presorted
+// runs that are merged on a small stack of run lengths (as TimSort). Stable.
+// No memory overhead other than small stack use.
 
 typedef int _SortListCompare (void *Data1, void *Data2);
 
-void *SortList (void **List, _SortListCompare *SortListCompare)
+// Merge two sorted lists. Ties take from A first
+void **SortListMerge (void **A, void **B, _SortListCompare *SortListCompare)
   {
-    void **left, **right;
-    void **left_, **right_, **List_;
-    void **Res, **Res_;
-    unsigned int i;
+    void *Res;
+    void **Res_;
     //
-    // Base case. A list of zero or one elements is sorted, by definition.
-    if (List == NULL)
-      return NULL;
-    if (*List == NULL)
-      return List;
-    // Divide the list into equal-sized sublists
-    left = NULL;
-    right = NULL;
+    Res_ = (void **) &Res;
+    while (A && B)
+      if (SortListCompare (B, A) < 0)   // add B
+        {
+          *Res_ = B;
+          Res_ = B;
+          B = (void **) *B;
+        }
+      else   // add A
+        {
+          *Res_ = A;
+          Res_ = A;
+          A = (void **) *A;
+        }
+    if (A)
+      *Res_ = A;
+    else
+      *Res_ = B;
+    return (void **) Res;
+  }
+
+// Cut the next run from *List. Descending runs are reversed
+void **SortListRun (void ***List, unsigned long *Length, _SortListCompare *SortListCompare)
+  {
+    void **Run, **Last, **Next;
     //
-    i = 0;
-    List_ = List;
-    left_ = (void **) &left;
-    right_ = (void **) &right;
-    while (List_)
+    Run = *List;
+    Last = Run;
+    Next = (void **) *Run;
+    *Length = 1;
+    if (Next && SortListCompare (Last, Next) > 0)   // strictly descending
       {
-        if (i & 1)   // odd index -> add left
+        *Run = NULL;
+        while (true)
           {
-            *left_ = List_;
-            left_ = List_;
+            Last = Next;
+            Next = (void **) *Last;
+            *Last = Run;   // reverse onto Run
+            Run = Last;
+            (*Length)++;
+            if (Next == NULL || SortListCompare (Last, Next) <= 0)
+              break;
           }
-        else   // add right
+      }
+    else
+      {
+        while (Next && SortListCompare (Last, Next) <= 0)
           {
-            *right_ = List_;
-            right_ = List_;
+            Last = Next;
+            Next = (void **) *Last;
+            (*Length)++;
           }
-        i++;
-        List_ = (void **) *List_;
-      }
-    *left_ = NULL;
-    *right_ = NULL;
-    // Recursively sort both sublists.
-    left = (void **) SortList (left, SortListCompare);
-    right = (void **) SortList (right, SortListCompare);
-    // Then merge the now-sorted sublists.
-    Res = NULL;
-    Res_ = (void **) &Res;
-    left_ = left;
-    right_ = right;
+        *Last = NULL;
+      }
+    *List = Next;
+    return Run;
+  }
+
+#define SortListStackSize 128   // Run lengths grow at least as Fibonacci
+
+void *SortList (void **List, _SortListCompare *SortListCompare)
+  {
+    void **Run [SortListStackSize];
+    unsigned long Length [SortListStackSize];
+    int n, k;
+    //
+    if (List == NULL)
+      return NULL;
+    n = 0;
     while (true)
       {
-        if (left_ && right_)   // both left and right still have data
-          if (SortListCompare (left_, right_) < 0)   // add left
-            {
-              *Res_ = left_;
-              left_ = (void **) *left_;
-            }
-          else   // add right
-            {
-              *Res_ = right_;
-              right_ = (void **) *right_;
-            }
-        else if (left_)   // add left
+        if (List)   // Push the next run
           {
-            *Res_ = left_;
-            left_ = (void **) *left_;
+            Run [n] = SortListRun (&List, &Length [n], SortListCompare);
+            n++;
           }
-        else if (right_)   // add right
+        // Merge runs to keep the stack balanced. Once the list is done, merge them all
+        while (n > 1)
           {
-            *Res_ = right_;
-            right_ = (void **) *right_;
+            k = n - 2;
+            if (List == NULL)
+              ;
+            else if ((k > 0 && Length [k - 1] <= Length [k] + Length [k + 1]) ||
+                     (k > 1 && Length [k - 2] <= Length [k - 1] + Length [k]))
+              {
+                if (Length [k - 1] < Length [k + 1])
+                  k--;
+              }
+            else if (Length [k] > Length [k + 1])
+              break;
+            Run [k] = SortListMerge (Run [k], Run [k + 1], SortListCompare);
+            Length [k] += Length [k + 1];
+            if (k + 2 < n)
+              {
+                Run [k + 1] = Run [k + 2];
+                Length [k + 1] = Length [k + 2];
+              }
+            n--;
           }
-        else
+        if (List == NULL)
           break;
-        Res_ = (void **) *Res_;
       }
-    return Res;
+    return Run [0];
+  }
+
+// Sort List in Threads parallel sublists then merge them
+// SortListCompare must be thread safe. Threads <= 0: one per processor
+
+#ifdef _Windows
+
+void *SortListParallel (void **List, _SortListCompare *SortListCompare, int Threads)
+  {
+    return SortList (List, SortListCompare);
+  }
+
+#else
+
+#define SortListParallelMin 4096   // Smallest sublist worth a thread
+#define SortListThreadsMax 64
+
+typedef struct
+  {
+    void **List;
+    _SortListCompare *SortListCompare;
+  } _SortListJob;
+
+void *SortListThread (void *Data)
+  {
+    _SortListJob *Job;
+    //
+    Job = (_SortListJob *) Data;
+    Job->List = (void **) SortList (Job->List, Job->SortListCompare);
+    return NULL;
+  }
+
+void *SortListParallel (void **List, _SortListCompare *SortListCompare, int Threads)
+  {
+    _SortListJob Job [SortListThreadsMax];
+    pthread_t Thread [SortListThreadsMax];
+    bool Started [SortListThreadsMax];
+    void **p, **Last;
+    unsigned long Size, Chunk, i;
+    int t, Step;
+    //
+    if (Threads <= 0)
+      Threads = sysconf (_SC_NPROCESSORS_ONLN);
+    if (Threads < 1)   // sysconf failed (-1)
+      Threads = 1;
+    if (Threads > SortListThreadsMax)
+      Threads = SortListThreadsMax;
+    Size = 0;
+    for (p = List; p; p = (void **) *p)
+      Size++;
+    if ((unsigned long) Threads > Size / SortListParallelMin)   // Threads >= 1 here
+      Threads = Size / SortListParallelMin;
+    if (Threads <= 1)
+      return SortList (List, SortListCompare);
+    // Cut into sublists, in order, and sort each on its own thread
+    Chunk = (Size + Threads - 1) / Threads;
+    for (t = 0; t < Threads; t++)
+      {
+        Job [t].List = List;
+        Job [t].SortListCompare = SortListCompare;
+        Last = NULL;
+        for (i = 0; i < Chunk && List; i++)
+          {
+            Last = List;
+            List = (void **) *List;
+          }
+        if (Last)
+          *Last = NULL;
+        Started [t] = (bool) (pthread_create (&Thread [t], NULL, SortListThread, &Job [t]) == 0);
+        if (!Started [t])   // do it here
+          SortListThread (&Job [t]);
+      }
+    for (t = 0; t < Threads; t++)
+      if (Started [t])
+        pthread_join (Thread [t], NULL);
+    // Merge neighbours pairwise (keeps it stable)
+    for (Step = 1; Step < Threads; Step <<= 1)
+      for (t = 0; t + Step < Threads; t += Step << 1)
+        Job [t].List = SortListMerge (Job [t].List, Job [t + Step].List, SortListCompare);
+    return Job [0].List;
   }
 
+#endif
+
 
 ////////////////////////////////////////////////////////////////////////////
 //
@@ -2203,7 +5606,7 @@ typedef struct
     int ID;
     longint Size;
     byte *Buffer;
-    unsigned int BufferPos;
+    longint BufferPos;
     unsigned int Line;
   } _TextFile;
 
@@ -2264,27 +5667,42 @@ _EndOfLine EOL (char *c)
     return eolNone;
   }
 
-char *TextFileReadln (_TextFile *File, bool Span)
+// Read Buffer if not yet read
+bool TextFileLoad (_TextFile *File)
   {
-    char *Res;
-    char *cp;
-    _EndOfLine eol;
+    longint Done, Got;
     //
-    Res = NULL;
-    if (File->ID > 0)
+    if (File->Buffer == NULL && File->ID > 0)
       {
-        // Read Buffer if not yet read
-        if (File->Buffer == NULL)
+        File->Buffer = (byte *) malloc (File->Size + 1);
+        Done = 0;
+        while (File->Buffer && Done < File->Size)
           {
-            File->Buffer = (byte *) malloc (File->Size + 1);
-            if (read (File->ID, File->Buffer, File->Size) == File->Size)
-              File->Buffer [File->Size] = 0;   // Terminate current line in buffer
+            Got = read (File->ID, File->Buffer + Done, File->Size - Done);   // Large files take more than one read
+            if (Got > 0)
+              Done += Got;
             else
               {
                 free (File->Buffer);
                 File->Buffer = NULL;
               }
           }
+        if (File->Buffer)
+          File->Buffer [File->Size] = 0;   // Terminate current line in buffer
+      }
+    return File->Buffer != NULL;
+  }
+
+char *TextFileReadln (_TextFile *File, bool Span)
+  {
+    char *Res;
+    char *cp;
+    _EndOfLine eol;
+    //
+    Res = NULL;
+    if (File->ID > 0)
+      {
+        TextFileLoad (File);
         if ((File->Buffer) && (File->BufferPos < File->Size))
           {
             Res = (char *) &File->Buffer [File->BufferPos];
@@ -2332,6 +5750,21 @@ char *TextFileReadln (_TextFile *File, bool Span)
     return Res;
   }
 
+// The remaining lines split into fields in place (see StrGetRecord). Returns the number read
+unsigned int TextFileRecords (_TextFile *File, bool Comma, _StrRecordCallback *CallBack, void *Data)
+  {
+    unsigned int Res;
+    char *p;
+    //
+    if (!TextFileLoad (File) || File->BufferPos >= File->Size)
+      return 0;
+    p = (char *) &File->Buffer [File->BufferPos];
+    Res = StrForEachRecord (&p, Comma, CallBack, Data);
+    File->BufferPos = (byte *) p - File->Buffer;
+    File->Line += Res;
+    return Res;
+  }
+
 char *TextFileSeakln (_TextFile *File, int Line, bool Span)
   {
     char *Res;
@@ -2376,6 +5809,292 @@ bool TextFileWriteln (_TextFile *File, char *St)
   }
 
 
+////////////////////////////////////////////////////////////////////////////
+//
+// MRU HISTORY
+//
+// _History: bounded most recently used list of strings, like a StringArray kept
+//   with StringArrayAdd, but add, promote and evict take constant time.
+//   The items form a doubly linked list from Newest to Oldest. Index maps the hash
+//   of each string to its item; items with the same hash are chained through Same.
+//   Saved and loaded in StringArrayWrite's format: one string per line.
+
+typedef struct _HistoryItem
+  {
+    char *St;
+    unsigned long long Hash;
+    struct _HistoryItem *Newer, *Older;
+    struct _HistoryItem *Same;   // Next item with the same Hash
+  } _HistoryItem;
+
+typedef struct
+  {
+    _HashMap Index;   // Hash to the first _HistoryItem with it
+    _HistoryItem *Newest, *Oldest;
+    int Count;
+    int Size;   // Most items kept, the oldest is dropped beyond that
+  } _History;
+
+void HistoryInit (_History *History, int Size)
+  {
+    HashMapInit (&History->Index, false);
+    History->Newest = NULL;
+    History->Oldest = NULL;
+    History->Count = 0;
+    History->Size = Size;
+  }
+
+void HistoryFree (_History *History)
+  {
+    _HistoryItem *Item;
+    //
+    while (History->Newest)
+      {
+        Item = History->Newest;
+        History->Newest = Item->Older;
+        free (Item->St);
+        PoolFree (Item, sizeof (_HistoryItem));
+      }
+    HashMapFree (&History->Index);
+    HistoryInit (History, History->Size);
+  }
+
+_HistoryItem *HistoryFind (_History *History, char *St)   // NULL if not there
+  {
+    _HashSlot *s;
+    _HistoryItem *Item;
+    //
+    s = HashMapFindInt (&History->Index, HashStr (St));
+    if (s)
+      for (Item = (_HistoryItem *) s->Value; Item; Item = Item->Same)
+        if (StrCompare (Item->St, St) == 0)
+          return Item;
+    return NULL;
+  }
+
+bool HistoryIndex (_History *History, _HistoryItem *Item)
+  {
+    _HashSlot *s;
+    //
+    s = HashMapAddInt (&History->Index, Item->Hash, NULL);
+    if (s == NULL)
+      return false;
+    Item->Same = (_HistoryItem *) s->Value;
+    s->Value = Item;
+    return true;
+  }
+
+void HistoryUnindex (_History *History, _HistoryItem *Item)
+  {
+    _HashSlot *s;
+    _HistoryItem *Prev;
+    //
+    s = HashMapFindInt (&History->Index, Item->Hash);
+    if (s->Value == Item)
+      {
+        s->Value = Item->Same;
+        if (s->Value == NULL)
+          HashMapRemoveInt (&History->Index, Item->Hash);
+      }
+    else
+      {
+        Prev = (_HistoryItem *) s->Value;
+        while (Prev->Same != Item)
+          Prev = Prev->Same;
+        Prev->Same = Item->Same;
+      }
+  }
+
+void HistoryUnlink (_History *History, _HistoryItem *Item)
+  {
+    if (Item->Newer)
+      Item->Newer->Older = Item->Older;
+    else
+      History->Newest = Item->Older;
+    if (Item->Older)
+      Item->Older->Newer = Item->Newer;
+    else
+      History->Oldest = Item->Newer;
+  }
+
+void HistoryLink (_History *History, _HistoryItem *Item, bool Newest)
+  {
+    if (Newest)
+      {
+        Item->Newer = NULL;
+        Item->Older = History->Newest;
+        if (History->Newest)
+          History->Newest->Newer = Item;
+        else
+          History->Oldest = Item;
+        History->Newest = Item;
+      }
+    else
+      {
+        Item->Older = NULL;
+        Item->Newer = History->Oldest;
+        if (History->Oldest)
+          History->Oldest->Older = Item;
+        else
+          History->Newest = Item;
+        History->Oldest = Item;
+      }
+  }
+
+void HistoryPromote (_History *History, _HistoryItem *Item)   // Make it the newest
+  {
+    if (Item != History->Newest)
+      {
+        HistoryUnlink (History, Item);
+        HistoryLink (History, Item, true);
+      }
+  }
+
+// St as the newest (Newest) or oldest item. An existing copy is promoted, or left alone
+// when adding as oldest. Full: the oldest item makes room, or St is dropped if it is to be
+// the oldest. Returns St's item or NULL
+_HistoryItem *HistoryInsert (_History *History, char *St, bool Newest)
+  {
+    _HistoryItem *Item;
+    //
+    if (St == NULL || History->Size <= 0)
+      return NULL;
+    Item = HistoryFind (History, St);
+    if (Item)
+      {
+        if (Newest)
+          HistoryPromote (History, Item);
+        return Item;
+      }
+    if (History->Count >= History->Size)
+      {
+        if (!Newest)
+          return NULL;
+        Item = History->Oldest;   // Reuse the dropped item
+        HistoryUnlink (History, Item);
+        HistoryUnindex (History, Item);
+        History->Count--;
+      }
+    else
+      {
+        Item = (_HistoryItem *) PoolAlloc (sizeof (_HistoryItem));
+        if (Item == NULL)
+          return NULL;
+        Item->St = NULL;
+      }
+    StrAssign (&Item->St, St);
+    Item->Hash = HashStr (St);
+    if (!HistoryIndex (History, Item))
+      {
+        free (Item->St);
+        PoolFree (Item, sizeof (_HistoryItem));
+        return NULL;
+      }
+    HistoryLink (History, Item, Newest);
+    History->Count++;
+    return Item;
+  }
+
+_HistoryItem *HistoryAdd (_History *History, char *St)   // As StringArrayAdd
+  {
+    return HistoryInsert (History, St, true);
+  }
+
+bool HistoryRemove (_History *History, char *St)   // false if not there
+  {
+    _HistoryItem *Item;
+    //
+    Item = HistoryFind (History, St);
+    if (Item == NULL)
+      return false;
+    HistoryUnlink (History, Item);
+    HistoryUnindex (History, Item);
+    History->Count--;
+    free (Item->St);
+    PoolFree (Item, sizeof (_HistoryItem));
+    return true;
+  }
+
+// Step from Item to an older (Step > 0) or newer item. From NULL, +1 is the newest.
+// NULL past either end
+_HistoryItem *HistoryNext (_History *History, _HistoryItem *Item, int Step)
+  {
+    if (Item == NULL)
+      {
+        if (Step <= 0)
+          return NULL;
+        Item = History->Newest;
+        Step--;
+      }
+    for (; Item && Step > 0; Step--)
+      Item = Item->Older;
+    for (; Item && Step < 0; Step++)
+      Item = Item->Newer;
+    return Item;
+  }
+
+bool HistoryRetrieve (_History *History, int n, char *Result, int ResultSize)   // As StringArrayRetrieve
+  {
+    _HistoryItem *Item;
+    //
+    if (n < 0)
+      return false;
+    Item = HistoryNext (History, NULL, n + 1);
+    if (Item == NULL)
+      return false;
+    StrCopyN (Result, Item->St, ResultSize);
+    return true;
+  }
+
+// Newest first, or oldest first if Reverse, as StringArrayWrite
+void HistoryWrite (_History *History, int file, bool Reverse)
+  {
+    _HistoryItem *Item;
+    //
+    for (Item = Reverse ? History->Oldest : History->Newest; Item; Item = Reverse ? Item->Newer : Item->Older)
+      {
+        write (file, Item->St, StrLength (Item->St));
+        write (file, &lf_, 1);
+      }
+  }
+
+// Adds the lines of a file from HistoryWrite with the same Reverse, older than the items
+// already in History. false if the file can't be read
+bool HistoryRead (_History *History, char *Filename, bool Reverse)
+  {
+    _TextFile File;
+    char **Line, **l;
+    int Count, Allocated, i;
+    //
+    if (!TextFileOpen (&File, Filename, foRead))
+      return false;
+    Line = NULL;
+    Count = 0;
+    Allocated = 0;
+    while (true)
+      {
+        if (Count >= Allocated)
+          {
+            Allocated = Allocated ? Allocated * 2 : 64;
+            l = (char **) realloc (Line, sizeof (char *) * Allocated);
+            if (l == NULL)
+              break;
+            Line = l;
+          }
+        Line [Count] = TextFileReadln (&File, false);
+        if (Line [Count] == NULL)
+          break;
+        if (Line [Count][0])
+          Count++;
+      }
+    for (i = 0; i < Count && History->Count < History->Size; i++)   // Newest first, each older than the last
+      HistoryInsert (History, Line [Reverse ? Count - 1 - i : i], false);
+    free (Line);
+    TextFileClose (&File);
+    return true;
+  }
+
+
 ////////////////////////////////////////////////////////////////////////////
 //
 // JUST BECAUSE ..............